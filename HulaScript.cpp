@@ -59,12 +59,16 @@ instance::value ffi_table_helper::get(instance::value key) const {
 }
 
 instance::value HulaScript::ffi_table_helper::get(std::string key) const {
+	return get(interned_key(key));
+}
+
+instance::value HulaScript::ffi_table_helper::get(interned_key key) const {
 	std::vector<instance::instruction> ins;
 	ins.push_back({ .operation = instance::opcode::LOAD_TABLE });
 	return owner_instance.execute_arbitrary(ins, 
 	{
 		instance::value(instance::value::vtype::TABLE, flags, 0, table_id),
-		instance::value(instance::value::value::INTERNAL_STRHASH, 0, 0, Hash::dj2b(key.c_str()))
+		instance::value(instance::value::value::INTERNAL_STRHASH, 0, 0, key.hash())
 	}, true).value();
 }
 
@@ -79,17 +83,23 @@ void ffi_table_helper::emplace(instance::value key, instance::value set_val) {
 }
 
 void HulaScript::ffi_table_helper::emplace(std::string key, instance::value set_val) {
+	emplace(interned_key(key), set_val);
+}
+
+void HulaScript::ffi_table_helper::emplace(interned_key key, instance::value set_val) {
 	std::vector<instance::instruction> ins;
 	ins.push_back({ .operation = instance::opcode::STORE_TABLE });
 	owner_instance.execute_arbitrary(ins, {
 		instance::value(instance::value::vtype::TABLE, flags, 0, table_id),
-		instance::value(instance::value::value::INTERNAL_STRHASH, 0, 0, Hash::dj2b(key.c_str())),
+		instance::value(instance::value::value::INTERNAL_STRHASH, 0, 0, key.hash()),
 		set_val
 	}, true);
 }
 
 const size_t HulaScript::ffi_table_helper::get_size() const
 {
-	instance::value length_value = get(std::string("@length"));
+	static constexpr interned_key length_key("@length");
+
+	instance::value length_value = get(length_key);
 	return length_value.index(0, INT64_MAX, owner_instance);
 }
\ No newline at end of file
@@ -5,7 +5,14 @@
 
 #include <cstdint>
 #include <cassert>
+#include <cstring>
+#include <bit>
+#include <array>
+#include <algorithm>
 #include <string>
+#include <string_view>
+#include <span>
+#include <type_traits>
 #include <vector>
 #include <memory>
 #include <functional>
@@ -16,10 +23,48 @@
 
 namespace HulaScript {
 	namespace Hash {
+		//folds from the last character so it matches the old recursive definition, which hosts still use for property names.
+		static size_t constexpr dj2b(char const* input, size_t length) {
+			size_t hash = 5381;
+			while (length > 0) {
+				length--;
+				hash = static_cast<size_t>(input[length]) + 33 * hash;
+			}
+			return hash;
+		}
+
 		static size_t constexpr dj2b(char const* input) {
-			return *input ?
-				static_cast<size_t>(*input) + 33 * dj2b(input + 1) :
-				5381;
+			return dj2b(input, std::char_traits<char>::length(input));
+		}
+
+		namespace detail {
+			//64x64->128 bit multiply, low half into a and high half into b
+			static constexpr void mum(uint64_t& a, uint64_t& b) noexcept {
+#if defined(__SIZEOF_INT128__)
+				__uint128_t r = static_cast<__uint128_t>(a) * b;
+				a = static_cast<uint64_t>(r);
+				b = static_cast<uint64_t>(r >> 64);
+#else
+				uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+				uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+				uint64_t t = rl + (rm0 << 32);
+				uint64_t c = t < rl;
+				uint64_t lo = t + (rm1 << 32);
+				c += lo < t;
+				a = lo;
+				b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+			}
+
+			static constexpr uint64_t mix(uint64_t a, uint64_t b) noexcept {
+				mum(a, b);
+				return a ^ b;
+			}
+		}
+
+		//hash used for string table keys and property/method names
+		static size_t constexpr strhash(std::string_view str) {
+			return dj2b(str.data(), str.size());
 		}
 
 		//copied straight from boost
@@ -29,6 +74,25 @@ namespace HulaScript {
 		}
 	}
 
+	//A string key hashed once, ie. static constexpr interned_key length_key("@length");
+	//Pass these to ffi_table_helper or load_property on hot paths instead of re-hashing std::strings.
+	class interned_key {
+	public:
+		constexpr interned_key(char const* name) : name_hash(Hash::strhash(name)) { }
+		constexpr interned_key(std::string_view name) : name_hash(Hash::strhash(name)) { }
+		interned_key(const std::string& name) : name_hash(Hash::strhash(name)) { }
+
+		constexpr size_t hash() const noexcept {
+			return name_hash;
+		}
+
+		constexpr bool operator==(const interned_key& other) const noexcept {
+			return name_hash == other.name_hash;
+		}
+	private:
+		size_t name_hash;
+	};
+
 	class instance {
 	public:
 		class foreign_object;
@@ -151,10 +215,10 @@ namespace HulaScript {
 					break;
 				case vtype::STRING: {
 					if constexpr (IsTableHash) {
-						return Hash::dj2b(data.str);
+						return Hash::strhash(data.str);
 					}
 					else {
-						payload = Hash::dj2b(data.str);
+						payload = Hash::strhash(data.str);
 						break;
 					}
 				}
@@ -218,6 +282,24 @@ namespace HulaScript {
 			friend class value;
 		public:
 			virtual ~foreign_object() = default;
+
+			//Inline cache support, declared last so older hosts keep their vtable slots.
+			//Objects with the same non-null type identity resolve a property name to the same method slot, so a host may cache (identity, slot) at a call site and invoke call_method directly on a hit.
+			virtual const void* type_identity() const noexcept { return nullptr; }
+
+			//The method slot a property name resolves to, or nothing if that property isn't a plain method.
+			virtual std::optional<uint32_t> method_slot(size_t name_hash) const noexcept { return std::nullopt; }
+
+			//Span calling convention, letting a host pass arguments straight from its stack. Copies into a vector for objects that only implement the vector overload.
+			//A distinct name rather than an overload, since MSVC groups overloaded virtuals together and that would shift the older slots.
+			virtual value call_method_span(uint32_t method_id, std::span<value> arguments, instance& instance) {
+				std::vector<value> argument_vector(arguments.begin(), arguments.end());
+				return call_method(method_id, argument_vector, instance);
+			}
+
+			value call_method(uint32_t method_id, std::span<value> arguments, instance& instance) {
+				return call_method_span(method_id, arguments, instance);
+			}
 		};
 
 		virtual std::string get_value_print_string(value to_print) = 0;
@@ -239,6 +321,23 @@ namespace HulaScript {
 		virtual value invoke_value(value to_call, std::vector<value> arguments) = 0;
 		virtual value invoke_method(value object, std::string method_name, std::vector<value> arguments) = 0;
 
+		//braced argument lists, ie. invoke_value(callback, { name }), stay on the stack
+		value invoke_value(value to_call, std::initializer_list<value> arguments) {
+			return invoke_value_span(to_call, std::span<const value>(arguments.begin(), arguments.size()));
+		}
+		value invoke_method(value object, std::string method_name, std::initializer_list<value> arguments) {
+			return invoke_method_span(object, method_name, std::span<const value>(arguments.begin(), arguments.size()));
+		}
+		value invoke_value(value to_call, std::span<const value> arguments) {
+			return invoke_value_span(to_call, arguments);
+		}
+		value invoke_method(value object, std::string method_name, std::span<const value> arguments) {
+			return invoke_method_span(object, method_name, arguments);
+		}
+		value make_foreign_function(std::function<value(std::span<value> arguments, instance& instance)> function) {
+			return make_span_foreign_function(function);
+		}
+
 		virtual bool declare_global(std::string name, value val) = 0;
 		virtual void panic(std::string msg) const = 0;
 
@@ -329,6 +428,21 @@ namespace HulaScript {
 
 		virtual std::optional<value> execute_arbitrary(const std::vector<instruction>& arbitrary_ins, const std::vector<value>& operands, bool return_value = false) = 0;
 
+	public:
+		//Span calling conventions, declared after every older virtual so existing hosts keep their vtable slots. They have their own names because MSVC groups overloaded virtuals together.
+		//The defaults copy into the vector versions; hosts that can pass arguments straight from their stack override them.
+		virtual value make_span_foreign_function(std::function<value(std::span<value> arguments, instance& instance)> function) {
+			return make_foreign_function(std::function<value(std::vector<value>& arguments, instance& instance)>([function](std::vector<value>& arguments, instance& instance) {
+				return function(std::span<value>(arguments), instance);
+			}));
+		}
+		virtual value invoke_value_span(value to_call, std::span<const value> arguments) {
+			return invoke_value(to_call, std::vector<value>(arguments.begin(), arguments.end()));
+		}
+		virtual value invoke_method_span(value object, std::string method_name, std::span<const value> arguments) {
+			return invoke_method(object, method_name, std::vector<value>(arguments.begin(), arguments.end()));
+		}
+
 		friend class ffi_table_helper;
 	};
 
@@ -342,8 +456,10 @@ namespace HulaScript {
 
 		instance::value get(instance::value key) const;
 		instance::value get(std::string key) const;
+		instance::value get(interned_key key) const;
 		void emplace(instance::value key, instance::value set_val);
 		void emplace(std::string key, instance::value set_val);
+		void emplace(interned_key key, instance::value set_val);
 
 		const bool is_array() const noexcept {
 			return flags & instance::value::vflags::TABLE_ARRAY_ITERATE;
@@ -366,66 +482,142 @@ namespace HulaScript {
 
 	extern instance::foreign_object* library_owner;
 
+	//A name-hash sorted table of member pointers, built at compile time and shared by every instance of a foreign object class.
+	template<typename member_type, size_t member_count>
+	class member_table {
+	public:
+		struct entry {
+			interned_key name;
+			member_type member;
+		};
+
+		constexpr member_table(const entry (&declared)[member_count]) : entries(std::to_array(declared)) {
+			std::sort(entries.begin(), entries.end(), [](const entry& a, const entry& b) { return a.name.hash() < b.name.hash(); });
+		}
+
+		constexpr std::optional<uint32_t> find(size_t name_hash) const noexcept {
+			size_t low = 0;
+			size_t high = member_count;
+			while (low < high) {
+				size_t mid = (low + high) / 2;
+				if (entries[mid].name.hash() < name_hash) {
+					low = mid + 1;
+				}
+				else {
+					high = mid;
+				}
+			}
+
+			if (low < member_count && entries[low].name.hash() == name_hash) {
+				return static_cast<uint32_t>(low);
+			}
+			return std::nullopt;
+		}
+
+		constexpr bool is_unique() const noexcept {
+			for (size_t i = 1; i < member_count; i++) {
+				if (entries[i - 1].name == entries[i].name) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		constexpr member_type operator[](uint32_t id) const noexcept {
+			return entries[id].member;
+		}
+
+		static constexpr size_t size() noexcept {
+			return member_count;
+		}
+	private:
+		std::array<entry, member_count> entries;
+	};
+
+	template<typename child_type>
+	using foreign_method = instance::value(child_type::*)(std::span<instance::value> arguments, instance& instance);
+
+	template<typename child_type>
+	using foreign_getter = instance::value(child_type::*)(instance& instance);
+
+	//ie. static constexpr HulaScript::method_table<file_object, 2> methods = {{ { "readLine", &file_object::read_line }, { "close", &file_object::close } }};
+	template<typename child_type, size_t method_count>
+	using method_table = member_table<foreign_method<child_type>, method_count>;
+
+	template<typename child_type, size_t getter_count>
+	using getter_table = member_table<foreign_getter<child_type>, getter_count>;
+
+	//child_type must declare a public static constexpr method_table named methods.
 	template<typename child_type>
 	class foreign_method_object : public instance::foreign_object {
 	public:
+		foreign_method_object() {
+			static_assert(child_type::methods.is_unique(), "Foreign object declares two methods with the same name.");
+		}
+
 		instance::value load_property(size_t name_hash, instance& instance) override {
-			auto it = method_id_lookup.find(name_hash);
-			if (it != method_id_lookup.end()) {
-				return instance::value(it->second, static_cast<foreign_object*>(this));
+			auto method_id = child_type::methods.find(name_hash);
+			if (method_id.has_value()) {
+				return instance::value(method_id.value(), static_cast<foreign_object*>(this));
 			}
 			return instance::value();
 		}
 
-		instance::value call_method(uint32_t method_id, std::vector<instance::value>& arguments, instance& instance) override {
-			if (method_id >= methods.size()) {
+		instance::value load_property(interned_key key, instance& instance) {
+			return load_property(key.hash(), instance);
+		}
+
+		instance::value call_method_span(uint32_t method_id, std::span<instance::value> arguments, instance& instance) override {
+			if (method_id >= child_type::methods.size()) {
 				return instance::value();
 			}
-			return (dynamic_cast<child_type*>(this)->*methods[method_id])(arguments, instance);
+			return (static_cast<child_type*>(this)->*child_type::methods[method_id])(arguments, instance);
+		}
+
+		instance::value call_method(uint32_t method_id, std::vector<instance::value>& arguments, instance& instance) override {
+			return call_method_span(method_id, std::span<instance::value>(arguments), instance);
+		}
+
+		instance::value call_method(uint32_t method_id, std::span<instance::value> arguments, instance& instance) {
+			return call_method_span(method_id, arguments, instance);
 		}
 
 		void trace(std::vector<instance::value>& to_trace) override {
 			to_trace.push_back(instance::value(library_owner));
 		}
-	protected:
-		bool declare_method(std::string name, instance::value(child_type::* method)(std::vector<instance::value>& arguments, instance& instance)) {
-			size_t name_hash = Hash::dj2b(name.c_str());
-			if (method_id_lookup.contains(name_hash)) {
-				return false;
-			}
 
-			method_id_lookup.insert(std::make_pair(name_hash, methods.size()));
-			methods.push_back(method);
-			return true;
+		const void* type_identity() const noexcept override {
+			return &child_type::methods;
+		}
+
+		std::optional<uint32_t> method_slot(size_t name_hash) const noexcept override {
+			return child_type::methods.find(name_hash);
 		}
-	private:
-		std::unordered_map<size_t, uint32_t> method_id_lookup;
-		std::vector<instance::value(child_type::*)(std::vector<instance::value>& arguments, instance& instance)> methods;
 	};
 
+	//child_type must also declare a public static constexpr getter_table named getters. Getters shadow methods of the same name.
 	template<typename child_type>
 	class foreign_getter_object : public foreign_method_object<child_type> {
-	private:
-		std::unordered_map<size_t, instance::value(child_type::*)(instance& instance)> getters;
-
 	public:
+		foreign_getter_object() {
+			static_assert(child_type::getters.is_unique(), "Foreign object declares two getters with the same name.");
+		}
+
+		using foreign_method_object<child_type>::load_property;
+
 		instance::value load_property(size_t name_hash, instance& instance) override {
-			auto it = getters.find(name_hash);
-			if (it == getters.end()) {
-				return dynamic_cast<foreign_method_object<child_type>*>(this)->load_property(name_hash, instance);
+			auto getter_id = child_type::getters.find(name_hash);
+			if (!getter_id.has_value()) {
+				return foreign_method_object<child_type>::load_property(name_hash, instance);
 			}
-			return (dynamic_cast<child_type*>(this)->*(it->second))(instance);
+			return (static_cast<child_type*>(this)->*child_type::getters[getter_id.value()])(instance);
 		}
 
-	protected:
-		bool declare_getter(std::string name, instance::value(child_type::* getter)(instance& instance)) {
-			size_t name_hash = Hash::dj2b(name.c_str());
-			if (getters.contains(name_hash)) {
-				return false;
+		std::optional<uint32_t> method_slot(size_t name_hash) const noexcept override {
+			if (child_type::getters.find(name_hash).has_value()) {
+				return std::nullopt;
 			}
-
-			getters.insert({ name_hash, getter });
-			return true;
+			return foreign_method_object<child_type>::method_slot(name_hash);
 		}
 	};
 }
\ No newline at end of file
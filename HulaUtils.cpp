@@ -4,20 +4,112 @@
 #include <sstream>
 #include <string>
 #include <filesystem>
+#include <cerrno>
 #include "HulaUtils.hpp"
 
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
 using namespace HulaUtils;
 
+//positional I/O leaves the stream's own position untouched
+static size_t positional_read(FILE* file, char* data, size_t bytes, int64_t offset) {
+	std::fflush(file);
+#ifdef _WIN32
+	int64_t saved = _ftelli64(file);
+	if (_fseeki64(file, offset, SEEK_SET) != 0) {
+		return 0;
+	}
+	size_t total = std::fread(data, sizeof(char), bytes, file);
+	_fseeki64(file, saved, SEEK_SET);
+	return total;
+#else
+	size_t total = 0;
+	while (total < bytes) {
+		ssize_t result = pread(fileno(file), data + total, bytes - total, offset + total);
+		if (result < 0 && errno == EINTR) {
+			continue;
+		}
+		else if (result <= 0) {
+			break;
+		}
+		total += result;
+	}
+	return total;
+#endif
+}
+
+static size_t positional_write(FILE* file, const char* data, size_t bytes, int64_t offset) {
+	std::fflush(file);
+#ifdef _WIN32
+	int64_t saved = _ftelli64(file);
+	if (_fseeki64(file, offset, SEEK_SET) != 0) {
+		return 0;
+	}
+	size_t total = std::fwrite(data, sizeof(char), bytes, file);
+	std::fflush(file);
+	_fseeki64(file, saved, SEEK_SET);
+	return total;
+#else
+	size_t total = 0;
+	while (total < bytes) {
+		ssize_t result = pwrite(fileno(file), data + total, bytes - total, offset + total);
+		if (result < 0 && errno == EINTR) {
+			continue;
+		}
+		else if (result <= 0) {
+			break;
+		}
+		total += result;
+	}
+	return total;
+#endif
+}
+
 DYNALO_EXPORT const char** DYNALO_CALL HulaUtils::manifest(HulaScript::instance::foreign_object* foreign_obj) {
 	static const char* my_functions[] = {
 		"openFile",
+		"openCompressed",
 		"dirInfo",
 		"dirTraverse",
+		"readFile",
+		"readLines",
+		"writeFile",
+		"readFiles",
+		"grepFiles",
+		"watch",
+		"hashString",
+		"hashFile",
+		"hashFiles",
+		"readFileAsync",
+		"waitAll",
+		"pollAll",
+		"waitAny",
+		"spawnHashFile",
+		"spawnParseJSON",
+		"spawnDirScan",
+		"spawnCmd",
 		"rem",
 		"remAll",
+		"copyFile",
+		"copyTree",
+		"moveFile",
 		"runCmd",
 		"JSONParser",
 		"toJSON",
+		"queryJSON",
+		"parseJSONLines",
+		"toBinary",
+		"toBinaryFile",
+		"CSVReader",
+		"Buffer",
+		"Float64Array",
+		"Int64Array",
 		"localTime",
 		"gmTime",
 		"unixTime",
@@ -102,7 +194,7 @@ DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::runCmd(std::vec
 	return HulaScript::instance::value();
 }
 
-HulaScript::instance::value HulaUtils::file_object::read_line(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+HulaScript::instance::value HulaUtils::file_object::read_line(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
 {
 	HULASCRIPT_EXPECT_ARGS(0);
 	if (infile == NULL) {
@@ -122,7 +214,7 @@ HulaScript::instance::value HulaUtils::file_object::read_line(std::vector<HulaSc
 	return instance.make_string(line);
 }
 
-HulaScript::instance::value HulaUtils::file_object::read_all_lines(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+HulaScript::instance::value HulaUtils::file_object::read_all_lines(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
 {
 	HULASCRIPT_EXPECT_ARGS(0);
 	if (infile == NULL) {
@@ -152,7 +244,7 @@ HulaScript::instance::value HulaUtils::file_object::read_all_lines(std::vector<H
 	return instance.make_array(lines);
 }
 
-HulaScript::instance::value HulaUtils::file_object::read_to_end(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+HulaScript::instance::value HulaUtils::file_object::read_to_end(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
 {
 	HULASCRIPT_EXPECT_ARGS(0);
 	if (infile == NULL) {
@@ -172,7 +264,7 @@ HulaScript::instance::value HulaUtils::file_object::read_to_end(std::vector<Hula
 	return instance.make_string(line);
 }
 
-HulaScript::instance::value HulaUtils::file_object::write(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+HulaScript::instance::value HulaUtils::file_object::write(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
 {
 	HULASCRIPT_EXPECT_ARGS(1);
 	if (infile == NULL) {
@@ -187,7 +279,7 @@ HulaScript::instance::value HulaUtils::file_object::write(std::vector<HulaScript
 	return HulaScript::instance::value(success);
 }
 
-HulaScript::instance::value HulaUtils::file_object::write_line(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+HulaScript::instance::value HulaUtils::file_object::write_line(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
 {
 	HULASCRIPT_EXPECT_ARGS(1);
 	if (infile == NULL) {
@@ -205,7 +297,136 @@ HulaScript::instance::value HulaUtils::file_object::write_line(std::vector<HulaS
 	return HulaScript::instance::value(success);
 }
 
-HulaScript::instance::value HulaUtils::file_object::close(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+HulaScript::instance::value HulaUtils::file_object::read_into(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	if (args.size() < 1 || args.size() > 3) {
+		instance.panic("FFI Error: Function received wrong number of arguments.");
+	}
+	if (infile == NULL) {
+		instance.panic("File handle object is closed.");
+		return HulaScript::instance::value(); //unreachable
+	}
+
+	native_array& array = expect_native_array(args[0], instance);
+	size_t count = array.length();
+	if (args.size() >= 2) {
+		count = args[1].index(0, array.length() + 1, instance);
+	}
+
+	if (args.size() == 3) {
+		size_t read = positional_read(infile, array.data_bytes(), count * array.element_size(), args[2].index(0, INT64_MAX, instance));
+		return instance.rational_integer(read / array.element_size());
+	}
+
+	size_t read = std::fread(array.data_bytes(), array.element_size(), count, infile);
+	return instance.rational_integer(read);
+}
+
+HulaScript::instance::value HulaUtils::file_object::write_from(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	if (args.size() < 1 || args.size() > 3) {
+		instance.panic("FFI Error: Function received wrong number of arguments.");
+	}
+	if (infile == NULL) {
+		instance.panic("File handle object is closed.");
+		return HulaScript::instance::value(); //unreachable
+	}
+
+	native_array& array = expect_native_array(args[0], instance);
+	size_t count = array.length();
+	if (args.size() >= 2) {
+		count = args[1].index(0, array.length() + 1, instance);
+	}
+
+	if (args.size() == 3) {
+		size_t bytes = count * array.element_size();
+		return HulaScript::instance::value(positional_write(infile, array.data_bytes(), bytes, args[2].index(0, INT64_MAX, instance)) == bytes);
+	}
+
+	bool success = std::fwrite(array.data_bytes(), array.element_size(), count, infile) == count;
+	return HulaScript::instance::value(success);
+}
+
+HulaScript::instance::value HulaUtils::file_object::seek(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	int origin = SEEK_SET;
+	if (args.size() == 2) {
+		std::string origin_name = args[1].str(instance);
+		switch (HulaScript::Hash::strhash(origin_name))
+		{
+		case HulaScript::Hash::strhash("begin"):
+			origin = SEEK_SET;
+			break;
+		case HulaScript::Hash::strhash("current"):
+			origin = SEEK_CUR;
+			break;
+		case HulaScript::Hash::strhash("end"):
+			origin = SEEK_END;
+			break;
+		default: {
+			std::stringstream ss;
+			ss << "Unknown seek origin \"" << origin_name << "\". Expected begin, current or end.";
+			instance.panic(ss.str());
+			break;
+		}
+		}
+	}
+	else {
+		HULASCRIPT_EXPECT_ARGS(1);
+	}
+	if (infile == NULL) {
+		instance.panic("File handle object is closed.");
+		return HulaScript::instance::value(); //unreachable
+	}
+
+	int64_t offset = static_cast<int64_t>(args[0].number(instance));
+#ifdef _WIN32
+	bool success = _fseeki64(infile, offset, origin) == 0;
+#else
+	bool success = fseeko(infile, offset, origin) == 0;
+#endif
+	return HulaScript::instance::value(success);
+}
+
+HulaScript::instance::value HulaUtils::file_object::tell(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(0);
+	if (infile == NULL) {
+		instance.panic("File handle object is closed.");
+		return HulaScript::instance::value(); //unreachable
+	}
+
+#ifdef _WIN32
+	return instance.rational_integer(_ftelli64(infile));
+#else
+	return instance.rational_integer(ftello(infile));
+#endif
+}
+
+HulaScript::instance::value HulaUtils::file_object::size(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(0);
+	if (infile == NULL) {
+		instance.panic("File handle object is closed.");
+		return HulaScript::instance::value(); //unreachable
+	}
+
+	std::fflush(infile);
+#ifdef _WIN32
+	struct _stat64 info;
+	if (_fstat64(_fileno(infile), &info) != 0) {
+		return HulaScript::instance::value();
+	}
+#else
+	struct stat info;
+	if (fstat(fileno(infile), &info) != 0) {
+		return HulaScript::instance::value();
+	}
+#endif
+	return instance.rational_integer(info.st_size);
+}
+
+HulaScript::instance::value HulaUtils::file_object::close(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
 {
 	HULASCRIPT_EXPECT_ARGS(0);
 	if (infile == NULL) {
@@ -5,6 +5,11 @@
 
 #include <cstdio>
 #include <ctime>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include "HulaScript.hpp"
 #include "process.h"
 
@@ -18,23 +23,39 @@ namespace HulaUtils {
 	private:
 		FILE* infile;
 
-		HulaScript::instance::value read_line(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
-		HulaScript::instance::value read_all_lines(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
-		HulaScript::instance::value read_to_end(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
-		HulaScript::instance::value write(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
-		HulaScript::instance::value write_line(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+		HulaScript::instance::value read_line(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value read_all_lines(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value read_to_end(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value write(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value write_line(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value read_into(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value write_from(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value seek(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value tell(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value size(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value read_async(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value write_async(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
 
-		HulaScript::instance::value close(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+		HulaScript::instance::value close(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
 
 	public:
-		file_object(FILE* infile) : infile(infile) {
-			declare_method("readLine", &file_object::read_line);
-			declare_method("readAllLines", &file_object::read_all_lines);
-			declare_method("readToEnd", &file_object::read_to_end);
-			declare_method("write", &file_object::write);
-			declare_method("writeLine", &file_object::write_line);
-			declare_method("close", &file_object::close);
-		}
+		static constexpr HulaScript::method_table<file_object, 13> methods = {{
+			{ "readLine", &file_object::read_line },
+			{ "readAllLines", &file_object::read_all_lines },
+			{ "readToEnd", &file_object::read_to_end },
+			{ "write", &file_object::write },
+			{ "writeLine", &file_object::write_line },
+			{ "readInto", &file_object::read_into },
+			{ "writeFrom", &file_object::write_from },
+			{ "seek", &file_object::seek },
+			{ "tell", &file_object::tell },
+			{ "size", &file_object::size },
+			{ "readAsync", &file_object::read_async },
+			{ "writeAsync", &file_object::write_async },
+			{ "close", &file_object::close }
+		}};
+
+		file_object(FILE* infile) : infile(infile) { }
 
 		~file_object() {
 			if (infile == NULL) {
@@ -44,32 +65,611 @@ namespace HulaUtils {
 		}
 	};
 
+	//Per-format codec behind a compressed_file_object; the implementations live in compressed.cpp.
+	class compressed_stream;
+
+	class compressed_file_object : public HulaScript::foreign_method_object<compressed_file_object> {
+	private:
+		std::unique_ptr<compressed_stream> stream;
+		bool writing;
+
+		std::vector<char> read_buffer;
+		size_t buffer_start = 0;
+		size_t buffer_end = 0;
+		bool at_end = false;
+
+		void expect_usable(bool for_writing, HulaScript::instance& instance);
+		bool fill_buffer(HulaScript::instance& instance);
+		size_t read_bytes(char* out, size_t size, HulaScript::instance& instance);
+		bool write_bytes(const char* data, size_t size);
+
+		HulaScript::instance::value read_line(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value read_all_lines(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value read_to_end(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value write(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value write_line(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value read_into(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value write_from(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+
+		HulaScript::instance::value close(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+
+	public:
+		static constexpr HulaScript::method_table<compressed_file_object, 8> methods = {{
+			{ "readLine", &compressed_file_object::read_line },
+			{ "readAllLines", &compressed_file_object::read_all_lines },
+			{ "readToEnd", &compressed_file_object::read_to_end },
+			{ "write", &compressed_file_object::write },
+			{ "writeLine", &compressed_file_object::write_line },
+			{ "readInto", &compressed_file_object::read_into },
+			{ "writeFrom", &compressed_file_object::write_from },
+			{ "close", &compressed_file_object::close }
+		}};
+
+		static constexpr size_t block_size = 128 * 1024;
+
+		compressed_file_object(std::unique_ptr<compressed_stream> stream, bool writing);
+		~compressed_file_object();
+	};
+
+	//One parsed object member. String keys stay native strings until a table actually needs them.
+	struct json_field {
+		bool string_key;
+		size_t key_hash;
+		std::string key;
+		HulaScript::instance::value key_value;
+		HulaScript::instance::value value;
+	};
+
+	enum class json_value_type : uint8_t {
+		ANY,
+		NUMBER,
+		STRING,
+		BOOLEAN,
+		ARRAY,
+		OBJECT,
+		FLOAT64_ARRAY,
+		INT64_ARRAY,
+		SCHEMA
+	};
+
+	struct json_schema_field {
+		std::string name;
+		json_value_type type;
+		//SCHEMA: name hash of the nested schema, looked up when parsing so schemas may refer to ones added later
+		size_t schema_hash;
+		//ARRAY: the element type; ANY if the schema didn't declare one
+		json_value_type item_type;
+		size_t item_schema_hash;
+		bool required;
+		HulaScript::instance::value default_value;
+	};
+
+	//An addSchema field list, with (key hash, field index) pairs sorted by hash for lookup while scanning.
+	struct json_schema {
+		std::vector<json_schema_field> fields;
+		std::vector<std::pair<size_t, uint32_t>> slots;
+	};
+
+	//An addConstructor registration compiled into (key hash, argument slot) pairs sorted by hash, so fields drop straight into the argument array.
+	//addSchema attaches a schema to the same registration; the constructor stays nil until one is added.
+	struct json_constructor_plan {
+		HulaScript::instance::value constructor;
+		std::vector<std::pair<size_t, uint32_t>> slots;
+		uint32_t argument_count;
+		std::shared_ptr<const json_schema> schema;
+	};
+
+	using json_constructor_plans = std::unordered_map<size_t, json_constructor_plan>;
+
+	//Invokes the @json_constructor among fields if there is one, and otherwise builds a table. The caller keeps the field values GC protected.
+	HulaScript::instance::value build_json_object(std::vector<json_field>& fields, const json_constructor_plans& plans, HulaScript::instance& instance);
+
 	class json_parser : public HulaScript::foreign_method_object<json_parser> {
 	private:
-		std::unordered_map<size_t, std::pair<HulaScript::instance::value, std::vector<std::string>>> object_parsers;
+		json_constructor_plans object_parsers;
+
+		HulaScript::instance::value add_constructor(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value parse_json(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value parse_lazy(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value from_binary(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value from_binary_file(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+
+		HulaScript::instance::value add_schema(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value parse_with_schema(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+
+		HulaScript::instance::value parse_binary(std::string_view source, HulaScript::instance& instance);
+	public:
+		static constexpr HulaScript::method_table<json_parser, 7> methods = {{
+			{ "addConstructor", &json_parser::add_constructor },
+			{ "parseJSON", &json_parser::parse_json },
+			{ "parseLazy", &json_parser::parse_lazy },
+			{ "fromBinary", &json_parser::from_binary },
+			{ "fromBinaryFile", &json_parser::from_binary_file },
+			{ "addSchema", &json_parser::add_schema },
+			{ "parseWithSchema", &json_parser::parse_with_schema }
+		}};
+
+		void trace(std::vector<HulaScript::instance::value>& to_trace) override {
+			foreign_method_object::trace(to_trace);
+			for (auto& registration : object_parsers) {
+				to_trace.push_back(registration.second.constructor);
+				if (registration.second.schema != nullptr) {
+					for (auto& field : registration.second.schema->fields) {
+						to_trace.push_back(field.default_value);
+					}
+				}
+			}
+		}
+	};
+
+	//A validated JSON document flattened into one entry per value. Containers link past their last child, so a subtree can be skipped without rescanning it.
+	class json_tape {
+	public:
+		enum class kind : uint8_t {
+			OBJECT,
+			ARRAY,
+			STRING,
+			NUMBER,
+			TRUE,
+			FALSE,
+			NIL
+		};
+
+		struct entry {
+			//OBJECT/ARRAY: index of the first entry after the container. Object keys: strhash of the decoded key.
+			uint64_t payload;
+			//byte offset into source; for strings, just past the opening quote
+			uint32_t start;
+			//STRING/NUMBER: byte length of the raw literal. OBJECT/ARRAY: child count.
+			uint32_t length;
+			kind type;
+			//STRING: contains escape sequences. NUMBER: has the rational suffix.
+			bool flagged;
+		};
+
+		std::string source;
+		std::vector<entry> entries;
+		//where source begins within a larger input, so error offsets refer to that input
+		size_t source_offset = 0;
+
+		json_tape(std::string source) : source(std::move(source)) { }
+
+		//Validates and indexes the whole source. Returns an error message rather than panicking, so it is safe off the interpreter thread.
+		//A value sequence accepts any number of whitespace separated top-level values (ie. JSON Lines); each root then follows the previous one's next().
+		std::optional<std::string> tokenize(bool value_sequence = false);
+
+		uint32_t next(uint32_t index) const noexcept {
+			const entry& current = entries[index];
+			return (current.type == kind::OBJECT || current.type == kind::ARRAY) ? static_cast<uint32_t>(current.payload) : index + 1;
+		}
+
+		std::string_view raw(const entry& current) const noexcept {
+			return std::string_view(source).substr(current.start, current.length);
+		}
+
+		std::string decode_string(const entry& current) const;
+		std::optional<uint32_t> find_field(uint32_t object_index, size_t key_hash) const noexcept;
+
+		HulaScript::instance::value scalar_value(const entry& current, HulaScript::instance& instance) const;
+		HulaScript::instance::value materialize(uint32_t index, HulaScript::instance& instance) const;
+
+		static bool decode_escapes(std::string_view raw, std::string& out);
+		//The first quote or backslash in [p, end), or end. Scans 16 bytes at a time where SSE2 is available.
+		static const char* find_quote_or_backslash(const char* p, const char* end) noexcept;
+		//Checks the contents of a JSON string: rejects unescaped control characters, overlong forms, surrogates and code points past U+10FFFF. Printable ASCII runs are checked 16 bytes at a time.
+		static bool validate_string(std::string_view text) noexcept;
+		static HulaScript::instance::value parse_number(std::string_view literal, bool rational, HulaScript::instance& instance);
+	};
+
+	//A view of one object or array in a json_tape. Fields turn into script values only when they are read.
+	class json_lazy_value : public HulaScript::foreign_getter_object<json_lazy_value> {
+	private:
+		std::shared_ptr<const json_tape> tape;
+		uint32_t index;
 
-		HulaScript::instance::value add_constructor(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
-		HulaScript::instance::value parse_json(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+		//materialized children by entry index, so repeated reads return the same value
+		std::unordered_map<uint32_t, HulaScript::instance::value> cache;
+
+		//built on first use: element entries of an array, or key entries of an object
+		std::vector<uint32_t> child_indices;
+		//key hash to value entry, for objects too large to scan linearly
+		std::unordered_map<size_t, uint32_t> field_lookup;
+
+		const std::vector<uint32_t>& children();
+		std::optional<uint32_t> field(size_t key_hash);
+		HulaScript::instance::value child_value(uint32_t child_index, HulaScript::instance& instance);
+
+		HulaScript::instance::value get(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value has(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value keys(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value to_value(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+
+		HulaScript::instance::value get_length(HulaScript::instance& instance);
+	protected:
+		std::string to_string() override;
 	public:
-		json_parser() {
-			declare_method("addConstructor", &json_parser::add_constructor);
-			declare_method("parseJSON", &json_parser::parse_json);
+		static constexpr HulaScript::method_table<json_lazy_value, 4> methods = {{
+			{ "get", &json_lazy_value::get },
+			{ "has", &json_lazy_value::has },
+			{ "keys", &json_lazy_value::keys },
+			{ "toValue", &json_lazy_value::to_value }
+		}};
+
+		static constexpr HulaScript::getter_table<json_lazy_value, 1> getters = {{
+			{ "length", &json_lazy_value::get_length }
+		}};
+
+		json_lazy_value(std::shared_ptr<const json_tape> tape, uint32_t index) : tape(tape), index(index) { }
+
+		//Falls back to the document's own fields for names that aren't a method or getter.
+		HulaScript::instance::value load_property(size_t name_hash, HulaScript::instance& instance) override;
+		using foreign_getter_object::load_property;
+
+		void trace(std::vector<HulaScript::instance::value>& to_trace) override {
+			foreign_getter_object::trace(to_trace);
+			for (auto& cached : cache) {
+				to_trace.push_back(cached.second);
+			}
 		}
 	};
 
+	//Wraps a container entry in a json_lazy_value; scalars come back as plain values.
+	HulaScript::instance::value make_lazy_json(std::shared_ptr<const json_tape> tape, uint32_t index, HulaScript::instance& instance);
+
+	//Contiguous native storage, implemented by every typed array so file I/O can target any of them.
+	class native_array {
+	public:
+		virtual ~native_array() = default;
+
+		virtual char* data_bytes() noexcept = 0;
+		virtual size_t element_size() const noexcept = 0;
+		virtual size_t length() const noexcept = 0;
+	};
+
+	native_array& expect_native_array(HulaScript::instance::value& value, HulaScript::instance& instance);
+
+	template<typename element_type>
+	class typed_array : public HulaScript::foreign_getter_object<typed_array<element_type>>, public native_array {
+	private:
+		std::vector<element_type> elements;
+
+		HulaScript::instance::value get(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value set(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value fill(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value slice(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value sum(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value minimum(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value maximum(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value map_op(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value to_array(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+
+		HulaScript::instance::value get_length(HulaScript::instance& instance);
+
+		template<typename operation>
+		HulaScript::instance::value elementwise(HulaScript::instance::value& operand, operation op, HulaScript::instance& instance);
+	protected:
+		HulaScript::instance::value add_operator(HulaScript::instance::value& operand, HulaScript::instance& instance) override;
+		HulaScript::instance::value subtract_operator(HulaScript::instance::value& operand, HulaScript::instance& instance) override;
+		HulaScript::instance::value multiply_operator(HulaScript::instance::value& operand, HulaScript::instance& instance) override;
+		HulaScript::instance::value divide_operator(HulaScript::instance::value& operand, HulaScript::instance& instance) override;
+
+		std::string to_string() override;
+	public:
+		static constexpr HulaScript::method_table<typed_array, 9> methods = {{
+			{ "get", &typed_array::get },
+			{ "set", &typed_array::set },
+			{ "fill", &typed_array::fill },
+			{ "slice", &typed_array::slice },
+			{ "sum", &typed_array::sum },
+			{ "min", &typed_array::minimum },
+			{ "max", &typed_array::maximum },
+			{ "map", &typed_array::map_op },
+			{ "toArray", &typed_array::to_array }
+		}};
+
+		static constexpr HulaScript::getter_table<typed_array, 1> getters = {{
+			{ "length", &typed_array::get_length }
+		}};
+
+		typed_array(size_t length) : elements(length) { }
+		typed_array(std::vector<element_type>&& elements) : elements(std::move(elements)) { }
+
+		std::vector<element_type>& get_elements() noexcept {
+			return elements;
+		}
+
+		char* data_bytes() noexcept override {
+			return reinterpret_cast<char*>(elements.data());
+		}
+
+		size_t element_size() const noexcept override {
+			return sizeof(element_type);
+		}
+
+		size_t length() const noexcept override {
+			return elements.size();
+		}
+	};
+
+	using buffer_object = typed_array<uint8_t>;
+	using float64_array = typed_array<double>;
+	using int64_array = typed_array<int64_t>;
+
+	extern template class typed_array<uint8_t>;
+	extern template class typed_array<double>;
+	extern template class typed_array<int64_t>;
+
+	//A whole file's bytes, read with a single call or memory-mapped when large. Safe to use off the interpreter thread.
+	class file_contents {
+	private:
+		const char* data;
+		size_t size;
+		bool mapped;
+		std::string buffer;
+
+		file_contents() : data(nullptr), size(0), mapped(false) { }
+	public:
+		static constexpr size_t mmap_threshold = 1 << 20;
+
+		static std::optional<file_contents> load(const std::string& path);
+
+		file_contents(file_contents&& other) noexcept;
+		file_contents(const file_contents&) = delete;
+		~file_contents();
+
+		std::string_view view() const noexcept {
+			return std::string_view(data, size);
+		}
+
+		//moves the bytes out, copying only if they were mapped
+		std::string take_string();
+	};
+
+	bool write_whole_file(const std::string& path, const char* data, size_t size, bool atomic);
+
+	//Streams records out of a CSV/TSV file held by file_contents. Every field is scanned for boundaries, but only the selected columns are decoded and converted.
+	class csv_reader_object : public HulaScript::foreign_method_object<csv_reader_object> {
+	public:
+		//a field's raw bytes; views into contents, so only valid while the file is open
+		struct field {
+			std::string_view raw;
+			bool quoted;
+			//contains doubled quotes that decoding collapses
+			bool escaped;
+		};
+	private:
+		std::optional<file_contents> contents;
+		size_t position;
+		char delimiter;
+		bool infer_types;
+
+		std::vector<std::string> names;
+		//source column index -> output slot, or -1 for columns that weren't selected
+		std::vector<int32_t> column_slots;
+
+		bool read_record(std::vector<field>& out, bool all_columns);
+		HulaScript::instance::value field_value(const field& current, HulaScript::instance& instance) const;
+		HulaScript::instance::value make_row(const std::vector<field>& fields, HulaScript::instance& instance) const;
+		HulaScript::instance::value make_column(const std::vector<field>& fields, HulaScript::instance& instance) const;
+		void expect_open(HulaScript::instance& instance) const;
+
+		HulaScript::instance::value get_columns(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value read_row(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value read_rows(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value read_batch(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value close(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+
+	protected:
+		std::string to_string() override {
+			return "CSVReader";
+		}
+
+	public:
+		static constexpr HulaScript::method_table<csv_reader_object, 5> methods = {{
+			{ "columns", &csv_reader_object::get_columns },
+			{ "readRow", &csv_reader_object::read_row },
+			{ "readRows", &csv_reader_object::read_rows },
+			{ "readBatch", &csv_reader_object::read_batch },
+			{ "close", &csv_reader_object::close }
+		}};
+
+		csv_reader_object(file_contents&& contents, char delimiter, bool infer_types) : contents(std::move(contents)), position(0), delimiter(delimiter), infer_types(infer_types) { }
+
+		//reads the header if there is one and maps the selected columns (names or indices) to output slots
+		void select_columns(bool has_header, std::optional<std::vector<HulaScript::instance::value>> selection, HulaScript::instance& instance);
+	};
+
+	//Library-wide worker threads for native-only work. Jobs must never touch the interpreter.
+	//Each worker runs its own queue in order and steals the oldest job from the others when it runs dry.
+	class thread_pool {
+	private:
+		struct worker_queue {
+			std::deque<std::function<void()>> jobs;
+			std::mutex mutex;
+		};
+
+		std::vector<std::thread> workers;
+		std::vector<std::unique_ptr<worker_queue>> queues;
+		std::atomic<size_t> next_queue;
+
+		//queued jobs not yet taken; goes briefly negative when a job is taken before its submitter counts it
+		std::atomic<int64_t> pending;
+		std::mutex sleep_mutex;
+		std::condition_variable jobs_available;
+		bool stopping;
+
+		bool take_job(size_t index, std::function<void()>& job);
+		void run_worker(size_t index);
+	public:
+		thread_pool(size_t thread_count);
+		~thread_pool();
+
+		void submit(std::function<void()> job);
+
+		//runs job(0) to job(count - 1) on the pool and the calling thread, returning once all have finished
+		void parallel_for(size_t count, const std::function<void(size_t)>& job);
+
+		size_t size() const noexcept {
+			return workers.size();
+		}
+	};
+
+	thread_pool& worker_pool();
+
+	//Completion slot shared by a native worker and a script-side future_object.
+	//Workers complete it with a materializer, which converts their native result into a value later on the interpreter thread.
+	class native_task {
+	public:
+		using materializer = std::function<HulaScript::instance::value(HulaScript::instance& instance)>;
+
+		void complete(materializer result);
+		bool is_done();
+		HulaScript::instance::value wait(HulaScript::instance& instance);
+
+		//blocks until ready returns true, rechecking it whenever any task completes; false if timeout_ms runs out first
+		static bool wait_until(const std::function<bool()>& ready, int64_t timeout_ms);
+	private:
+		std::mutex mutex;
+		std::condition_variable done_condition;
+		bool done = false;
+		materializer result;
+	};
+
+	class future_object : public HulaScript::foreign_method_object<future_object> {
+	private:
+		std::shared_ptr<native_task> task;
+		std::optional<HulaScript::instance::value> result;
+
+		HulaScript::instance::value wait(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value ready(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+	protected:
+		std::string to_string() override {
+			return "Future";
+		}
+	public:
+		static constexpr HulaScript::method_table<future_object, 2> methods = {{
+			{ "wait", &future_object::wait },
+			{ "ready", &future_object::ready }
+		}};
+
+		future_object(std::shared_ptr<native_task> task) : task(task) { }
+
+		HulaScript::instance::value get_result(HulaScript::instance& instance);
+
+		bool is_ready() {
+			return result.has_value() || task->is_done();
+		}
+
+		void trace(std::vector<HulaScript::instance::value>& to_trace) override {
+			foreign_method_object::trace(to_trace);
+			if (result.has_value()) {
+				to_trace.push_back(result.value());
+			}
+		}
+	};
+
+	future_object& expect_future(HulaScript::instance::value& value, HulaScript::instance& instance);
+
+	//Watches files and directories through inotify. Raw events are merged per path, so each batch reports one entry per changed path.
+	class watch_object : public HulaScript::foreign_method_object<watch_object> {
+	private:
+		enum change_kind {
+			CREATED = 1,
+			MODIFIED = 2,
+			DELETED = 4,
+			OVERFLOWED = 8
+		};
+
+		int fd;
+		bool recursive;
+		std::unordered_map<int, std::string> watched_paths;
+
+		std::unordered_map<std::string, size_t> pending_index;
+		std::vector<std::pair<std::string, int>> pending;
+
+		bool add_watch(const std::string& path);
+		void record(const std::string& path, int change);
+		bool drain_events(int timeout_ms);
+		HulaScript::instance::value take_batch(HulaScript::instance& instance);
+
+		HulaScript::instance::value poll(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value next(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+		HulaScript::instance::value close(std::span<HulaScript::instance::value> args, HulaScript::instance& instance);
+	protected:
+		std::string to_string() override {
+			return "Watcher";
+		}
+	public:
+		static constexpr HulaScript::method_table<watch_object, 3> methods = {{
+			{ "poll", &watch_object::poll },
+			{ "next", &watch_object::next },
+			{ "close", &watch_object::close }
+		}};
+
+		watch_object(int fd, bool recursive) : fd(fd), recursive(recursive) { }
+		~watch_object();
+
+		void add_root(const std::string& path, HulaScript::instance& instance);
+	};
+
+	//Copies one regular file, preserving its permission bits; a failed copy leaves no destination behind.
+	bool copy_file_contents(const std::string& from, const std::string& to, bool overwrite);
+
+	enum class hash_algorithm {
+		XXH3,
+		CRC32C,
+		SHA256
+	};
+
+	//Lowercase hex digest of a byte range; safe to call from worker threads.
+	std::string hash_digest(hash_algorithm algorithm, const char* data, size_t size);
+	hash_algorithm expect_hash_algorithm(HulaScript::instance::value& value, HulaScript::instance& instance);
+
 	DYNALO_EXPORT const char** DYNALO_CALL manifest(HulaScript::instance::foreign_object* foreign_obj);
 
 	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL openFile(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL openCompressed(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
 	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL dirInfo(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
 	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL dirTraverse(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
 
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL readFile(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL readLines(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL writeFile(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL readFiles(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL grepFiles(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL watch(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL hashString(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL hashFile(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL hashFiles(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL readFileAsync(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL waitAll(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL pollAll(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL waitAny(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL spawnHashFile(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL spawnParseJSON(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL spawnDirScan(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL spawnCmd(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+
 	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL rem(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
 	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL remAll(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL copyFile(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL copyTree(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL moveFile(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
 
 	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL runCmd(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
 
 	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL JSONParser(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
 	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL toJSON(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL parseJSONLines(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL queryJSON(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL toBinary(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL toBinaryFile(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL CSVReader(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL Buffer(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL Float64Array(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
+	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL Int64Array(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
 
 	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL localTime(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
 	DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL gmTime(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance);
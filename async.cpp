@@ -0,0 +1,898 @@
+#include "HulaUtils.hpp"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <io.h>
+#include <Windows.h>
+#else
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace HulaUtils;
+
+//the pool and queue the current thread works for, so jobs submitted from inside a job stay on that worker's deque
+static thread_local thread_pool* current_pool = nullptr;
+static thread_local size_t current_queue = 0;
+
+HulaUtils::thread_pool::thread_pool(size_t thread_count) : next_queue(0), pending(0), stopping(false) {
+	queues.reserve(thread_count);
+	for (size_t i = 0; i < thread_count; i++) {
+		queues.push_back(std::make_unique<worker_queue>());
+	}
+	workers.reserve(thread_count);
+	for (size_t i = 0; i < thread_count; i++) {
+		workers.emplace_back([this, i]() { run_worker(i); });
+	}
+}
+
+HulaUtils::thread_pool::~thread_pool() {
+	{
+		std::lock_guard<std::mutex> guard(sleep_mutex);
+		stopping = true;
+	}
+	jobs_available.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+bool HulaUtils::thread_pool::take_job(size_t index, std::function<void()>& job) {
+	{
+		worker_queue& own = *queues[index];
+		std::lock_guard<std::mutex> guard(own.mutex);
+		if (!own.jobs.empty()) {
+			job = std::move(own.jobs.front());
+			own.jobs.pop_front();
+			pending.fetch_sub(1);
+			return true;
+		}
+	}
+
+	for (size_t offset = 1; offset < queues.size(); offset++) {
+		worker_queue& victim = *queues[(index + offset) % queues.size()];
+		std::lock_guard<std::mutex> guard(victim.mutex);
+		if (!victim.jobs.empty()) {
+			job = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+			pending.fetch_sub(1);
+			return true;
+		}
+	}
+	return false;
+}
+
+void HulaUtils::thread_pool::run_worker(size_t index) {
+	current_pool = this;
+	current_queue = index;
+
+	for (;;) {
+		std::function<void()> job;
+		if (take_job(index, job)) {
+			job();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		jobs_available.wait(lock, [this]() { return stopping || pending.load() > 0; });
+		if (stopping && pending.load() <= 0) {
+			return;
+		}
+	}
+}
+
+void HulaUtils::thread_pool::submit(std::function<void()> job) {
+	//outside submitters spread their jobs round-robin; idle workers steal whatever lands unevenly
+	size_t index = current_pool == this ? current_queue : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+	{
+		worker_queue& queue = *queues[index];
+		std::lock_guard<std::mutex> guard(queue.mutex);
+		queue.jobs.push_back(std::move(job));
+	}
+	{
+		std::lock_guard<std::mutex> guard(sleep_mutex);
+		pending.fetch_add(1);
+	}
+	jobs_available.notify_one();
+}
+
+void HulaUtils::thread_pool::parallel_for(size_t count, const std::function<void(size_t)>& job) {
+	if (count == 0) {
+		return;
+	}
+
+	//helpers that start after every index is claimed only touch the shared state, never job
+	struct loop_state {
+		std::atomic<size_t> next;
+		std::atomic<size_t> remaining;
+		size_t count;
+		const std::function<void(size_t)>* job;
+		std::mutex mutex;
+		std::condition_variable finished;
+	};
+	auto state = std::make_shared<loop_state>();
+	state->next = 0;
+	state->remaining = count;
+	state->count = count;
+	state->job = &job;
+
+	auto drain = [state]() {
+		size_t completed = 0;
+		for (size_t i = state->next.fetch_add(1); i < state->count; i = state->next.fetch_add(1)) {
+			(*state->job)(i);
+			completed++;
+		}
+		if (completed > 0 && state->remaining.fetch_sub(completed) == completed) {
+			std::lock_guard<std::mutex> guard(state->mutex);
+			state->finished.notify_all();
+		}
+	};
+
+	size_t helpers = std::min(count - 1, workers.size());
+	for (size_t i = 0; i < helpers; i++) {
+		submit(drain);
+	}
+	drain();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->finished.wait(lock, [&state]() { return state->remaining.load() == 0; });
+}
+
+thread_pool& HulaUtils::worker_pool() {
+	static thread_pool pool(std::max<size_t>(1, std::thread::hardware_concurrency()));
+	return pool;
+}
+
+//signalled whenever any task completes, so a caller can wait on several tasks at once
+static std::mutex completion_mutex;
+static std::condition_variable any_completed;
+
+void HulaUtils::native_task::complete(materializer result) {
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		this->result = std::move(result);
+		done = true;
+	}
+	done_condition.notify_all();
+	{
+		std::lock_guard<std::mutex> guard(completion_mutex);
+	}
+	any_completed.notify_all();
+}
+
+bool HulaUtils::native_task::is_done() {
+	std::lock_guard<std::mutex> guard(mutex);
+	return done;
+}
+
+HulaScript::instance::value HulaUtils::native_task::wait(HulaScript::instance& instance) {
+	materializer to_materialize;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		done_condition.wait(lock, [this]() { return done; });
+		to_materialize = std::move(result);
+	}
+
+	try {
+		return to_materialize(instance);
+	}
+	catch (...) {
+		//put it back so waiting again reports the same error
+		std::lock_guard<std::mutex> guard(mutex);
+		result = std::move(to_materialize);
+		throw;
+	}
+}
+
+bool HulaUtils::native_task::wait_until(const std::function<bool()>& ready, int64_t timeout_ms) {
+	std::unique_lock<std::mutex> lock(completion_mutex);
+	if (timeout_ms < 0) {
+		any_completed.wait(lock, ready);
+		return true;
+	}
+	return any_completed.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+}
+
+HulaScript::instance::value HulaUtils::future_object::get_result(HulaScript::instance& instance) {
+	if (!result.has_value()) {
+		result = task->wait(instance);
+	}
+	return result.value();
+}
+
+HulaScript::instance::value HulaUtils::future_object::wait(std::span<HulaScript::instance::value> args, HulaScript::instance& instance) {
+	HULASCRIPT_EXPECT_ARGS(0);
+	return get_result(instance);
+}
+
+HulaScript::instance::value HulaUtils::future_object::ready(std::span<HulaScript::instance::value> args, HulaScript::instance& instance) {
+	HULASCRIPT_EXPECT_ARGS(0);
+	return HulaScript::instance::value(is_ready());
+}
+
+future_object& HulaUtils::expect_future(HulaScript::instance::value& value, HulaScript::instance& instance) {
+	future_object* future = dynamic_cast<future_object*>(value.foreign_obj(instance));
+	if (future == nullptr) {
+		instance.panic("Type Error: Expected a Future.");
+	}
+	return *future;
+}
+
+enum class io_kind {
+	READ_BUFFER,
+	READ_STRING,
+	WRITE
+};
+
+struct io_request {
+	io_kind kind;
+	int fd;
+	int64_t offset;
+
+	//destination for reads, source for writes
+	std::vector<uint8_t> data;
+	size_t transferred = 0;
+
+	//set when the size isn't known up front, ie. for pipes and procfs files
+	bool read_to_eof = false;
+
+	std::shared_ptr<native_task> task;
+};
+
+static void close_fd(int fd) {
+#ifdef _WIN32
+	_close(fd);
+#else
+	close(fd);
+#endif
+}
+
+static int64_t read_at(int fd, uint8_t* data, size_t length, int64_t offset) {
+#ifdef _WIN32
+	OVERLAPPED overlapped = {};
+	overlapped.Offset = static_cast<DWORD>(offset);
+	overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+	DWORD read = 0;
+	if (!ReadFile(reinterpret_cast<HANDLE>(_get_osfhandle(fd)), data, static_cast<DWORD>(std::min<size_t>(length, 1u << 30)), &read, &overlapped)) {
+		return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+	}
+	return read;
+#else
+	return pread(fd, data, length, offset);
+#endif
+}
+
+static int64_t write_at(int fd, const uint8_t* data, size_t length, int64_t offset) {
+#ifdef _WIN32
+	OVERLAPPED overlapped = {};
+	overlapped.Offset = static_cast<DWORD>(offset);
+	overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+	DWORD written = 0;
+	if (!WriteFile(reinterpret_cast<HANDLE>(_get_osfhandle(fd)), data, static_cast<DWORD>(std::min<size_t>(length, 1u << 30)), &written, &overlapped)) {
+		return -1;
+	}
+	return written;
+#else
+	return pwrite(fd, data, length, offset);
+#endif
+}
+
+static void finish_request(std::unique_ptr<io_request> request, bool success) {
+	close_fd(request->fd);
+
+	std::shared_ptr<native_task> task = request->task;
+	if (!success) {
+		task->complete([](HulaScript::instance&) { return HulaScript::instance::value(); });
+		return;
+	}
+
+	switch (request->kind)
+	{
+	case io_kind::READ_BUFFER:
+		request->data.resize(request->transferred);
+		task->complete([data = std::move(request->data)](HulaScript::instance& instance) mutable {
+			return instance.add_foreign_object(std::make_unique<buffer_object>(std::move(data)));
+		});
+		break;
+	case io_kind::READ_STRING:
+		task->complete([str = std::string(request->data.begin(), request->data.begin() + request->transferred)](HulaScript::instance& instance) {
+			return instance.make_string(str);
+		});
+		break;
+	case io_kind::WRITE:
+		task->complete([](HulaScript::instance&) { return HulaScript::instance::value(true); });
+		break;
+	}
+}
+
+//the worker-pool path, also used whenever io_uring is unavailable or its ring is full
+static void run_blocking(std::unique_ptr<io_request> request) {
+	bool success = true;
+	for (;;) {
+		if (request->transferred == request->data.size()) {
+			if (!request->read_to_eof) {
+				break;
+			}
+			request->data.resize(std::max<size_t>(4096, request->data.size() * 2));
+		}
+
+		int64_t result;
+		if (request->kind == io_kind::WRITE) {
+			result = write_at(request->fd, request->data.data() + request->transferred, request->data.size() - request->transferred, request->offset + request->transferred);
+		}
+		else {
+			result = read_at(request->fd, request->data.data() + request->transferred, request->data.size() - request->transferred, request->offset + request->transferred);
+		}
+
+		if (result < 0 && errno == EINTR) {
+			continue;
+		}
+		else if (result < 0) {
+			success = false;
+			break;
+		}
+		else if (result == 0) {
+			success = request->kind != io_kind::WRITE;
+			break;
+		}
+		request->transferred += result;
+	}
+	finish_request(std::move(request), success);
+}
+
+static void run_on_pool(std::unique_ptr<io_request> request) {
+	io_request* pending = request.release();
+	worker_pool().submit([pending]() { run_blocking(std::unique_ptr<io_request>(pending)); });
+}
+
+#ifdef __linux__
+//A single shared io_uring. Script threads submit under a lock; a reaper thread drains completions and re-submits short transfers.
+class io_ring {
+private:
+	int ring_fd;
+	io_uring_params params;
+
+	void* sq_ring;
+	void* cq_ring;
+	size_t sq_ring_size;
+	size_t cq_ring_size;
+
+	unsigned* sq_head;
+	unsigned* sq_tail;
+	unsigned sq_mask;
+	unsigned* sq_array;
+	io_uring_sqe* sqes;
+
+	unsigned* cq_head;
+	unsigned* cq_tail;
+	unsigned cq_mask;
+	io_uring_cqe* cqes;
+
+	std::mutex submit_mutex;
+	unsigned in_flight;
+	bool stopping;
+	std::thread reaper;
+
+	bool setup() {
+		std::memset(&params, 0, sizeof(params));
+		ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, 256, &params));
+		if (ring_fd < 0) {
+			return false;
+		}
+
+		sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+		if (single_mmap) {
+			sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+		}
+
+		sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+		if (sq_ring == MAP_FAILED) {
+			close(ring_fd);
+			return false;
+		}
+		cq_ring = single_mmap ? sq_ring : mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+		if (cq_ring == MAP_FAILED) {
+			munmap(sq_ring, sq_ring_size);
+			close(ring_fd);
+			return false;
+		}
+		sqes = static_cast<io_uring_sqe*>(mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES));
+		if (sqes == MAP_FAILED) {
+			if (!single_mmap) {
+				munmap(cq_ring, cq_ring_size);
+			}
+			munmap(sq_ring, sq_ring_size);
+			close(ring_fd);
+			return false;
+		}
+
+		char* sq = static_cast<char*>(sq_ring);
+		sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+		sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+		sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+		sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+		char* cq = static_cast<char*>(cq_ring);
+		cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+		cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+		cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+		cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+		return true;
+	}
+
+	//expects submit_mutex to be held
+	bool push_sqe(uint8_t opcode, int fd, uint64_t address, uint32_t length, uint64_t offset, uint64_t user_data) {
+		unsigned tail = *sq_tail;
+		if (tail - std::atomic_ref<unsigned>(*sq_head).load(std::memory_order_acquire) >= params.sq_entries) {
+			return false;
+		}
+
+		unsigned index = tail & sq_mask;
+		io_uring_sqe& sqe = sqes[index];
+		std::memset(&sqe, 0, sizeof(sqe));
+		sqe.opcode = opcode;
+		sqe.fd = fd;
+		sqe.addr = address;
+		sqe.len = length;
+		sqe.off = offset;
+		sqe.user_data = user_data;
+		sq_array[index] = index;
+		std::atomic_ref<unsigned>(*sq_tail).store(tail + 1, std::memory_order_release);
+
+		long submitted;
+		do {
+			submitted = syscall(__NR_io_uring_enter, ring_fd, 1, 0, 0, nullptr, 0);
+		} while (submitted < 0 && errno == EINTR);
+
+		if (submitted != 1) {
+			//the kernel never consumed it, so it's safe to take back
+			std::atomic_ref<unsigned>(*sq_tail).store(tail, std::memory_order_release);
+			return false;
+		}
+		in_flight++;
+		return true;
+	}
+
+	void complete(io_request* request, int result) {
+		std::unique_ptr<io_request> owned(request);
+		if (result == -EINTR || result == -EAGAIN) {
+			resubmit(std::move(owned));
+		}
+		else if (result == -EINVAL || result == -EOPNOTSUPP) {
+			//kernels before 5.6 lack IORING_OP_READ/WRITE
+			run_on_pool(std::move(owned));
+		}
+		else if (result < 0) {
+			finish_request(std::move(owned), false);
+		}
+		else if (result == 0) {
+			bool success = owned->kind != io_kind::WRITE;
+			finish_request(std::move(owned), success);
+		}
+		else {
+			owned->transferred += result;
+			if (owned->transferred < owned->data.size()) {
+				resubmit(std::move(owned));
+			}
+			else {
+				finish_request(std::move(owned), true);
+			}
+		}
+	}
+
+	void resubmit(std::unique_ptr<io_request> request) {
+		if (!submit(request.get())) {
+			run_on_pool(std::move(request));
+			return;
+		}
+		request.release();
+	}
+
+	void reap() {
+		for (;;) {
+			unsigned head = *cq_head;
+			if (head == std::atomic_ref<unsigned>(*cq_tail).load(std::memory_order_acquire)) {
+				syscall(__NR_io_uring_enter, ring_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+				continue;
+			}
+
+			io_uring_cqe cqe = cqes[head & cq_mask];
+			std::atomic_ref<unsigned>(*cq_head).store(head + 1, std::memory_order_release);
+			{
+				std::lock_guard<std::mutex> guard(submit_mutex);
+				in_flight--;
+			}
+
+			if (cqe.user_data == 0) {
+				return;
+			}
+			complete(reinterpret_cast<io_request*>(cqe.user_data), cqe.res);
+		}
+	}
+
+	io_ring() : ring_fd(-1), in_flight(0), stopping(false) {
+		if (setup()) {
+			reaper = std::thread([this]() { reap(); });
+		}
+	}
+public:
+	~io_ring() {
+		if (ring_fd < 0) {
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(submit_mutex);
+			stopping = true;
+			while (!push_sqe(IORING_OP_NOP, -1, 0, 0, 0, 0)) { }
+		}
+		reaper.join();
+
+		munmap(sqes, params.sq_entries * sizeof(io_uring_sqe));
+		if (cq_ring != sq_ring) {
+			munmap(cq_ring, cq_ring_size);
+		}
+		munmap(sq_ring, sq_ring_size);
+		close(ring_fd);
+	}
+
+	static io_ring* shared() {
+		static io_ring ring;
+		return ring.ring_fd >= 0 ? &ring : nullptr;
+	}
+
+	//false if the ring is full; the caller keeps ownership and should fall back to the worker pool
+	bool submit(io_request* request) {
+		std::lock_guard<std::mutex> guard(submit_mutex);
+		if (stopping || in_flight >= params.cq_entries) {
+			return false;
+		}
+
+		size_t remaining = request->data.size() - request->transferred;
+		return push_sqe(
+			request->kind == io_kind::WRITE ? IORING_OP_WRITE : IORING_OP_READ,
+			request->fd,
+			reinterpret_cast<uint64_t>(request->data.data() + request->transferred),
+			static_cast<uint32_t>(std::min<size_t>(remaining, 1u << 30)),
+			static_cast<uint64_t>(request->offset + request->transferred),
+			reinterpret_cast<uint64_t>(request));
+	}
+};
+#endif
+
+static HulaScript::instance::value submit_request(std::unique_ptr<io_request> request, HulaScript::instance& instance) {
+	auto task = std::make_shared<native_task>();
+	request->task = task;
+
+#ifdef __linux__
+	io_ring* ring = io_ring::shared();
+	if (!request->read_to_eof && !request->data.empty() && ring != nullptr && ring->submit(request.get())) {
+		request.release();
+		return instance.add_foreign_object(std::make_unique<future_object>(task));
+	}
+#endif
+
+	run_on_pool(std::move(request));
+	return instance.add_foreign_object(std::make_unique<future_object>(task));
+}
+
+static HulaScript::instance::value failed_future(HulaScript::instance& instance) {
+	auto task = std::make_shared<native_task>();
+	task->complete([](HulaScript::instance&) { return HulaScript::instance::value(); });
+	return instance.add_foreign_object(std::make_unique<future_object>(task));
+}
+
+//async requests own a duplicate descriptor, so closing the file_object early can't pull the file out from under them
+static int duplicate_fd(FILE* file) {
+	std::fflush(file);
+#ifdef _WIN32
+	return _dup(_fileno(file));
+#else
+	return fcntl(fileno(file), F_DUPFD_CLOEXEC, 0);
+#endif
+}
+
+HulaScript::instance::value HulaUtils::file_object::read_async(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(2);
+	if (infile == NULL) {
+		instance.panic("File handle object is closed.");
+		return HulaScript::instance::value(); //unreachable
+	}
+
+	size_t count = args[0].index(0, INT64_MAX, instance);
+	int64_t offset = args[1].index(0, INT64_MAX, instance);
+
+	int fd = duplicate_fd(infile);
+	if (fd < 0) {
+		return failed_future(instance);
+	}
+
+	auto request = std::make_unique<io_request>();
+	request->kind = io_kind::READ_BUFFER;
+	request->fd = fd;
+	request->offset = offset;
+	request->data.resize(count);
+	return submit_request(std::move(request), instance);
+}
+
+HulaScript::instance::value HulaUtils::file_object::write_async(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(2);
+	if (infile == NULL) {
+		instance.panic("File handle object is closed.");
+		return HulaScript::instance::value(); //unreachable
+	}
+
+	auto request = std::make_unique<io_request>();
+	request->kind = io_kind::WRITE;
+	request->offset = args[1].index(0, INT64_MAX, instance);
+	if (args[0].check_type(HulaScript::instance::value::vtype::FOREIGN_OBJECT)) {
+		native_array& array = expect_native_array(args[0], instance);
+		uint8_t* begin = reinterpret_cast<uint8_t*>(array.data_bytes());
+		request->data.assign(begin, begin + array.length() * array.element_size());
+	}
+	else {
+		std::string str = instance.get_value_print_string(args[0]);
+		request->data.assign(str.begin(), str.end());
+	}
+
+	request->fd = duplicate_fd(infile);
+	if (request->fd < 0) {
+		return failed_future(instance);
+	}
+	return submit_request(std::move(request), instance);
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::readFileAsync(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(1);
+
+	std::string path = args[0].str(instance);
+#ifdef _WIN32
+	int fd = _open(path.c_str(), _O_RDONLY | _O_BINARY);
+	struct _stat64 info;
+	if (fd < 0 || _fstat64(fd, &info) != 0) {
+#else
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	struct stat info;
+	if (fd < 0 || fstat(fd, &info) != 0) {
+#endif
+		if (fd >= 0) {
+			close_fd(fd);
+		}
+		return failed_future(instance);
+	}
+
+	auto request = std::make_unique<io_request>();
+	request->kind = io_kind::READ_STRING;
+	request->fd = fd;
+	request->offset = 0;
+	request->data.resize(info.st_size);
+	request->read_to_eof = info.st_size == 0;
+	return submit_request(std::move(request), instance);
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::waitAll(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(1);
+
+	HulaScript::ffi_table_helper futures(args[0], instance);
+	size_t count = futures.get_size();
+
+	std::vector<HulaScript::instance::value> results;
+	results.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		auto future = futures.get(instance.rational_integer(i));
+		results.push_back(expect_future(future, instance).get_result(instance));
+	}
+	return instance.make_array(results);
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::pollAll(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(1);
+
+	HulaScript::ffi_table_helper futures(args[0], instance);
+	size_t count = futures.get_size();
+
+	std::vector<HulaScript::instance::value> ready;
+	for (size_t i = 0; i < count; i++) {
+		auto future = futures.get(instance.rational_integer(i));
+		if (expect_future(future, instance).is_ready()) {
+			ready.push_back(instance.rational_integer(i));
+		}
+	}
+	return instance.make_array(ready);
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::waitAny(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	int64_t timeout_ms = -1;
+	if (args.size() == 2) {
+		timeout_ms = args[1].index(0, INT64_MAX, instance);
+	}
+	else {
+		HULASCRIPT_EXPECT_ARGS(1);
+	}
+
+	HulaScript::ffi_table_helper helper(args[0], instance);
+	size_t count = helper.get_size();
+
+	std::vector<future_object*> futures;
+	futures.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		auto future = helper.get(instance.rational_integer(i));
+		futures.push_back(&expect_future(future, instance));
+	}
+
+	size_t first_ready = count;
+	auto any_ready = [&futures, &first_ready]() {
+		for (size_t i = 0; i < futures.size(); i++) {
+			if (futures[i]->is_ready()) {
+				first_ready = i;
+				return true;
+			}
+		}
+		return false;
+	};
+	if (count == 0 || !native_task::wait_until(any_ready, timeout_ms)) {
+		return HulaScript::instance::value();
+	}
+	return instance.rational_integer(first_ready);
+}
+
+//runs work on the pool; the materializer it returns builds the script value once the future is waited on
+static HulaScript::instance::value spawn_task(std::function<native_task::materializer()> work, HulaScript::instance& instance) {
+	auto task = std::make_shared<native_task>();
+	worker_pool().submit([task, work = std::move(work)]() {
+		task->complete(work());
+	});
+	return instance.add_foreign_object(std::make_unique<future_object>(task));
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::spawnHashFile(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	hash_algorithm algorithm = hash_algorithm::XXH3;
+	if (args.size() == 2) {
+		algorithm = expect_hash_algorithm(args[1], instance);
+	}
+	else {
+		HULASCRIPT_EXPECT_ARGS(1);
+	}
+
+	return spawn_task([path = args[0].str(instance), algorithm]() -> native_task::materializer {
+		auto contents = file_contents::load(path);
+		if (!contents.has_value()) {
+			return [](HulaScript::instance&) { return HulaScript::instance::value(); };
+		}
+		std::string_view view = contents->view();
+		return [digest = hash_digest(algorithm, view.data(), view.size())](HulaScript::instance& instance) {
+			return instance.make_string(digest);
+		};
+	}, instance);
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::spawnParseJSON(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(1);
+
+	//only tokenizing happens on the worker; values are created when the future is waited on
+	auto tape = std::make_shared<json_tape>(args[0].str(instance));
+	return spawn_task([tape]() -> native_task::materializer {
+		auto error = tape->tokenize();
+		if (error.has_value()) {
+			return [message = error.value()](HulaScript::instance& instance) {
+				instance.panic(message);
+				return HulaScript::instance::value(); //unreachable
+			};
+		}
+		return [tape](HulaScript::instance& instance) {
+			return tape->materialize(0, instance);
+		};
+	}, instance);
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::spawnDirScan(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	bool recursive = false;
+	if (args.size() == 2) {
+		recursive = args[1].boolean(instance);
+	}
+	else {
+		HULASCRIPT_EXPECT_ARGS(1);
+	}
+
+	return spawn_task([path = args[0].str(instance), recursive]() -> native_task::materializer {
+		auto dirs = std::make_shared<std::vector<std::string>>();
+		auto files = std::make_shared<std::vector<std::string>>();
+
+		std::error_code error;
+		auto record = [&](const std::filesystem::directory_entry& entry) {
+			std::error_code entry_error;
+			if (entry.is_directory(entry_error)) {
+				dirs->push_back(entry.path().string());
+			}
+			else {
+				files->push_back(entry.path().string());
+			}
+		};
+		if (recursive) {
+			for (auto it = std::filesystem::recursive_directory_iterator(path, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+				record(*it);
+			}
+		}
+		else {
+			for (auto it = std::filesystem::directory_iterator(path, error); !error && it != std::filesystem::directory_iterator(); it.increment(error)) {
+				record(*it);
+			}
+		}
+		if (error) {
+			return [](HulaScript::instance&) { return HulaScript::instance::value(); };
+		}
+
+		//same layout as dirInfo
+		return [dirs, files](HulaScript::instance& instance) {
+			auto to_array = [&instance](const std::vector<std::string>& paths) {
+				std::vector<HulaScript::instance::value> names;
+				names.reserve(paths.size());
+				for (auto& name : paths) {
+					names.push_back(instance.make_string(name));
+					instance.temp_gc_protect(names.back());
+				}
+				auto result = instance.make_array(names);
+				for (size_t i = 0; i < names.size(); i++) {
+					instance.temp_gc_unprotect();
+				}
+				return result;
+			};
+
+			auto dir_list = to_array(*dirs);
+			instance.temp_gc_protect(dir_list);
+			auto file_list = to_array(*files);
+			instance.temp_gc_protect(file_list);
+
+			auto result = instance.make_table_obj({
+				std::make_pair("subDirs", dir_list),
+				std::make_pair("files", file_list)
+			});
+			instance.temp_gc_unprotect();
+			instance.temp_gc_unprotect();
+			return result;
+		};
+	}, instance);
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::spawnCmd(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	std::string cmd;
+	for (auto& arg : args) {
+		cmd.append(instance.get_value_print_string(arg));
+	}
+
+	return spawn_task([cmd]() -> native_task::materializer {
+		int status = std::system(cmd.c_str());
+#ifndef _WIN32
+		//report the exit code rather than the raw wait status; a signalled or unstartable command reads as -1
+		status = (status != -1 && WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+#endif
+		return [status](HulaScript::instance& instance) {
+			return instance.rational_integer(status);
+		};
+	}, instance);
+}
@@ -0,0 +1,437 @@
+#include "HulaUtils.hpp"
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <type_traits>
+
+using namespace HulaUtils;
+
+//Int64Array arithmetic panics instead of wrapping, since signed overflow is undefined
+static int64_t checked_add(int64_t a, int64_t b, HulaScript::instance& instance) {
+	int64_t result;
+#if defined(__GNUC__) || defined(__clang__)
+	if (__builtin_add_overflow(a, b, &result)) {
+#else
+	result = static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+	if ((b > 0 && a > INT64_MAX - b) || (b < 0 && a < INT64_MIN - b)) {
+#endif
+		instance.panic("Typed Array Error: Int64Array arithmetic overflowed.");
+	}
+	return result;
+}
+
+static int64_t checked_subtract(int64_t a, int64_t b, HulaScript::instance& instance) {
+	int64_t result;
+#if defined(__GNUC__) || defined(__clang__)
+	if (__builtin_sub_overflow(a, b, &result)) {
+#else
+	result = static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+	if ((b < 0 && a > INT64_MAX + b) || (b > 0 && a < INT64_MIN + b)) {
+#endif
+		instance.panic("Typed Array Error: Int64Array arithmetic overflowed.");
+	}
+	return result;
+}
+
+static int64_t checked_multiply(int64_t a, int64_t b, HulaScript::instance& instance) {
+	int64_t result;
+#if defined(__GNUC__) || defined(__clang__)
+	if (__builtin_mul_overflow(a, b, &result)) {
+#else
+	result = static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+	if (a != 0 && ((a == -1 && b == INT64_MIN) || (b == -1 && a == INT64_MIN) || result / a != b)) {
+#endif
+		instance.panic("Typed Array Error: Int64Array arithmetic overflowed.");
+	}
+	return result;
+}
+
+//casting a NaN, an infinity or anything past the element type's range to an integer is undefined, so those panic
+template<typename element_type>
+static element_type element_from_double(double number, HulaScript::instance& instance) {
+	if constexpr (std::is_floating_point_v<element_type>) {
+		return number;
+	}
+	else {
+		//both bounds are exact powers of two as doubles; the upper one is exclusive
+		constexpr double lower = static_cast<double>(std::numeric_limits<element_type>::min());
+		constexpr double upper = static_cast<double>(std::numeric_limits<element_type>::max() / 2 + 1) * 2.0;
+		if (!(number >= lower && number < upper)) {
+			std::stringstream ss;
+			ss << "Typed Array Error: " << number << " doesn't fit in " << (std::is_same_v<element_type, uint8_t> ? "a byte" : "a 64-bit integer") << '.';
+			instance.panic(ss.str());
+		}
+		return static_cast<element_type>(number);
+	}
+}
+
+template<typename element_type>
+static HulaScript::instance::value element_to_value(element_type element, HulaScript::instance& instance) {
+	if constexpr (std::is_floating_point_v<element_type>) {
+		return HulaScript::instance::value(element);
+	}
+	else {
+		return instance.rational_integer(static_cast<int64_t>(element));
+	}
+}
+
+template<typename element_type>
+static element_type element_from_value(const HulaScript::instance::value& value, HulaScript::instance& instance) {
+	if constexpr (std::is_floating_point_v<element_type>) {
+		return value.number(instance);
+	}
+	else if constexpr (std::is_same_v<element_type, uint8_t>) {
+		return static_cast<uint8_t>(value.index(0, 256, instance));
+	}
+	else {
+		return element_from_double<element_type>(value.number(instance), instance);
+	}
+}
+
+template<typename element_type>
+static const char* array_type_name() {
+	if constexpr (std::is_same_v<element_type, uint8_t>) {
+		return "Buffer";
+	}
+	else if constexpr (std::is_same_v<element_type, double>) {
+		return "Float64Array";
+	}
+	else {
+		return "Int64Array";
+	}
+}
+
+native_array& HulaUtils::expect_native_array(HulaScript::instance::value& value, HulaScript::instance& instance) {
+	native_array* array = dynamic_cast<native_array*>(value.foreign_obj(instance));
+	if (array == nullptr) {
+		instance.panic("Type Error: Expected a Buffer, Float64Array or Int64Array.");
+	}
+	return *array;
+}
+
+template<typename element_type>
+HulaScript::instance::value typed_array<element_type>::get(std::span<HulaScript::instance::value> args, HulaScript::instance& instance) {
+	HULASCRIPT_EXPECT_ARGS(1);
+	return element_to_value(elements[args[0].index(0, elements.size(), instance)], instance);
+}
+
+template<typename element_type>
+HulaScript::instance::value typed_array<element_type>::set(std::span<HulaScript::instance::value> args, HulaScript::instance& instance) {
+	HULASCRIPT_EXPECT_ARGS(2);
+	elements[args[0].index(0, elements.size(), instance)] = element_from_value<element_type>(args[1], instance);
+	return args[1];
+}
+
+template<typename element_type>
+HulaScript::instance::value typed_array<element_type>::fill(std::span<HulaScript::instance::value> args, HulaScript::instance& instance) {
+	HULASCRIPT_EXPECT_ARGS(1);
+	std::fill(elements.begin(), elements.end(), element_from_value<element_type>(args[0], instance));
+	return HulaScript::instance::value();
+}
+
+template<typename element_type>
+HulaScript::instance::value typed_array<element_type>::slice(std::span<HulaScript::instance::value> args, HulaScript::instance& instance) {
+	size_t end = elements.size();
+	if (args.size() == 2) {
+		end = args[1].index(0, elements.size() + 1, instance);
+	}
+	else {
+		HULASCRIPT_EXPECT_ARGS(1);
+	}
+	size_t begin = args[0].index(0, end + 1, instance);
+
+	std::vector<element_type> sliced(elements.begin() + begin, elements.begin() + end);
+	return instance.add_foreign_object(std::make_unique<typed_array<element_type>>(std::move(sliced)));
+}
+
+template<typename element_type>
+HulaScript::instance::value typed_array<element_type>::sum(std::span<HulaScript::instance::value> args, HulaScript::instance& instance) {
+	HULASCRIPT_EXPECT_ARGS(0);
+
+	if constexpr (std::is_floating_point_v<element_type>) {
+		//independent accumulators so the adds can be pipelined/vectorized without reassociating a single chain
+		double partial[4] = { 0, 0, 0, 0 };
+		size_t i = 0;
+		for (; i + 4 <= elements.size(); i += 4) {
+			partial[0] += elements[i];
+			partial[1] += elements[i + 1];
+			partial[2] += elements[i + 2];
+			partial[3] += elements[i + 3];
+		}
+		for (; i < elements.size(); i++) {
+			partial[0] += elements[i];
+		}
+		return HulaScript::instance::value((partial[0] + partial[1]) + (partial[2] + partial[3]));
+	}
+	else {
+		int64_t total = 0;
+		for (element_type element : elements) {
+			total = checked_add(total, element, instance);
+		}
+		return instance.rational_integer(total);
+	}
+}
+
+template<typename element_type>
+HulaScript::instance::value typed_array<element_type>::minimum(std::span<HulaScript::instance::value> args, HulaScript::instance& instance) {
+	HULASCRIPT_EXPECT_ARGS(0);
+	if (elements.empty()) {
+		return HulaScript::instance::value();
+	}
+
+	element_type result = elements[0];
+	for (element_type element : elements) {
+		result = element < result ? element : result;
+	}
+	return element_to_value(result, instance);
+}
+
+template<typename element_type>
+HulaScript::instance::value typed_array<element_type>::maximum(std::span<HulaScript::instance::value> args, HulaScript::instance& instance) {
+	HULASCRIPT_EXPECT_ARGS(0);
+	if (elements.empty()) {
+		return HulaScript::instance::value();
+	}
+
+	element_type result = elements[0];
+	for (element_type element : elements) {
+		result = element > result ? element : result;
+	}
+	return element_to_value(result, instance);
+}
+
+template<typename element_type>
+HulaScript::instance::value typed_array<element_type>::map_op(std::span<HulaScript::instance::value> args, HulaScript::instance& instance) {
+	HULASCRIPT_EXPECT_ARGS(1);
+
+	std::string op = args[0].str(instance);
+	std::vector<element_type> result(elements.size());
+	auto apply = [this, &result, &instance](auto kernel) {
+		for (size_t i = 0; i < elements.size(); i++) {
+			auto mapped = kernel(elements[i]);
+			if constexpr (std::is_floating_point_v<decltype(mapped)>) {
+				result[i] = element_from_double<element_type>(mapped, instance);
+			}
+			else {
+				result[i] = static_cast<element_type>(mapped);
+			}
+		}
+	};
+
+	switch (HulaScript::Hash::strhash(op))
+	{
+	case HulaScript::Hash::strhash("neg"):
+		if constexpr (std::is_same_v<element_type, int64_t>) {
+			apply([&instance](element_type e) { return checked_subtract(0, e, instance); });
+		}
+		else {
+			apply([](element_type e) { return -e; });
+		}
+		break;
+	case HulaScript::Hash::strhash("abs"):
+		if constexpr (std::is_same_v<element_type, int64_t>) {
+			apply([&instance](element_type e) { return e < 0 ? checked_subtract(0, e, instance) : e; });
+		}
+		else {
+			apply([](element_type e) { return e < 0 ? -e : e; });
+		}
+		break;
+	case HulaScript::Hash::strhash("square"):
+		if constexpr (std::is_same_v<element_type, int64_t>) {
+			apply([&instance](element_type e) { return checked_multiply(e, e, instance); });
+		}
+		else {
+			apply([](element_type e) { return e * e; });
+		}
+		break;
+	case HulaScript::Hash::strhash("sqrt"):
+		apply([](element_type e) { return std::sqrt(static_cast<double>(e)); });
+		break;
+	case HulaScript::Hash::strhash("floor"):
+		apply([](element_type e) { return std::floor(static_cast<double>(e)); });
+		break;
+	case HulaScript::Hash::strhash("ceil"):
+		apply([](element_type e) { return std::ceil(static_cast<double>(e)); });
+		break;
+	case HulaScript::Hash::strhash("round"):
+		apply([](element_type e) { return std::round(static_cast<double>(e)); });
+		break;
+	case HulaScript::Hash::strhash("exp"):
+		apply([](element_type e) { return std::exp(static_cast<double>(e)); });
+		break;
+	case HulaScript::Hash::strhash("log"):
+		apply([](element_type e) { return std::log(static_cast<double>(e)); });
+		break;
+	default: {
+		std::stringstream ss;
+		ss << "Typed Array Error: Unknown map operation \"" << op << "\". Expected neg, abs, square, sqrt, floor, ceil, round, exp or log.";
+		instance.panic(ss.str());
+		break;
+	}
+	}
+
+	return instance.add_foreign_object(std::make_unique<typed_array<element_type>>(std::move(result)));
+}
+
+template<typename element_type>
+HulaScript::instance::value typed_array<element_type>::to_array(std::span<HulaScript::instance::value> args, HulaScript::instance& instance) {
+	HULASCRIPT_EXPECT_ARGS(0);
+
+	std::vector<HulaScript::instance::value> values;
+	values.reserve(elements.size());
+	for (element_type element : elements) {
+		values.push_back(element_to_value(element, instance));
+	}
+	return instance.make_array(values);
+}
+
+template<typename element_type>
+HulaScript::instance::value typed_array<element_type>::get_length(HulaScript::instance& instance) {
+	return instance.rational_integer(elements.size());
+}
+
+template<typename element_type>
+template<typename operation>
+HulaScript::instance::value typed_array<element_type>::elementwise(HulaScript::instance::value& operand, operation op, HulaScript::instance& instance) {
+	std::vector<element_type> result(elements.size());
+
+	if (operand.check_type(HulaScript::instance::value::vtype::FOREIGN_OBJECT)) {
+		auto other = dynamic_cast<typed_array<element_type>*>(operand.foreign_obj(instance));
+		if (other == nullptr) {
+			std::stringstream ss;
+			ss << "Typed Array Error: Element-wise operand must be a number or another " << array_type_name<element_type>() << '.';
+			instance.panic(ss.str());
+		}
+		if (other->elements.size() != elements.size()) {
+			std::stringstream ss;
+			ss << "Typed Array Error: Length mismatch, " << elements.size() << " vs " << other->elements.size() << '.';
+			instance.panic(ss.str());
+		}
+
+		for (size_t i = 0; i < elements.size(); i++) {
+			result[i] = static_cast<element_type>(op(elements[i], other->elements[i]));
+		}
+	}
+	else {
+		element_type scalar = element_from_value<element_type>(operand, instance);
+		for (size_t i = 0; i < elements.size(); i++) {
+			result[i] = static_cast<element_type>(op(elements[i], scalar));
+		}
+	}
+
+	return instance.add_foreign_object(std::make_unique<typed_array<element_type>>(std::move(result)));
+}
+
+template<typename element_type>
+HulaScript::instance::value typed_array<element_type>::add_operator(HulaScript::instance::value& operand, HulaScript::instance& instance) {
+	if constexpr (std::is_same_v<element_type, int64_t>) {
+		return elementwise(operand, [&instance](element_type a, element_type b) { return checked_add(a, b, instance); }, instance);
+	}
+	else {
+		return elementwise(operand, [](element_type a, element_type b) { return a + b; }, instance);
+	}
+}
+
+template<typename element_type>
+HulaScript::instance::value typed_array<element_type>::subtract_operator(HulaScript::instance::value& operand, HulaScript::instance& instance) {
+	if constexpr (std::is_same_v<element_type, int64_t>) {
+		return elementwise(operand, [&instance](element_type a, element_type b) { return checked_subtract(a, b, instance); }, instance);
+	}
+	else {
+		return elementwise(operand, [](element_type a, element_type b) { return a - b; }, instance);
+	}
+}
+
+template<typename element_type>
+HulaScript::instance::value typed_array<element_type>::multiply_operator(HulaScript::instance::value& operand, HulaScript::instance& instance) {
+	if constexpr (std::is_same_v<element_type, int64_t>) {
+		return elementwise(operand, [&instance](element_type a, element_type b) { return checked_multiply(a, b, instance); }, instance);
+	}
+	else {
+		return elementwise(operand, [](element_type a, element_type b) { return a * b; }, instance);
+	}
+}
+
+template<typename element_type>
+HulaScript::instance::value typed_array<element_type>::divide_operator(HulaScript::instance::value& operand, HulaScript::instance& instance) {
+	if constexpr (std::is_integral_v<element_type>) {
+		bool has_zero;
+		if (operand.check_type(HulaScript::instance::value::vtype::FOREIGN_OBJECT)) {
+			auto other = dynamic_cast<typed_array<element_type>*>(operand.foreign_obj(instance));
+			has_zero = other != nullptr && std::find(other->elements.begin(), other->elements.end(), 0) != other->elements.end();
+		}
+		else {
+			has_zero = element_from_value<element_type>(operand, instance) == 0;
+		}
+
+		if (has_zero) {
+			instance.panic("Typed Array Error: Integer division by zero.");
+		}
+	}
+	if constexpr (std::is_same_v<element_type, int64_t>) {
+		return elementwise(operand, [&instance](element_type a, element_type b) {
+			if (a == INT64_MIN && b == -1) {
+				instance.panic("Typed Array Error: Int64Array arithmetic overflowed.");
+			}
+			return a / b;
+		}, instance);
+	}
+	else {
+		return elementwise(operand, [](element_type a, element_type b) { return a / b; }, instance);
+	}
+}
+
+template<typename element_type>
+std::string typed_array<element_type>::to_string() {
+	std::stringstream ss;
+	ss << array_type_name<element_type>() << '(' << elements.size() << ')';
+	return ss.str();
+}
+
+template<typename element_type>
+static HulaScript::instance::value make_typed_array(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance) {
+	HULASCRIPT_EXPECT_ARGS(1);
+
+	if (args[0].check_type(HulaScript::instance::value::vtype::TABLE)) {
+		HulaScript::ffi_table_helper helper(args[0], instance);
+		if (!helper.is_array()) {
+			instance.panic("Typed Array Error: Expected a length or an array of numbers.");
+		}
+
+		size_t size = helper.get_size();
+		std::vector<element_type> elements;
+		elements.reserve(size);
+		for (size_t i = 0; i < size; i++) {
+			elements.push_back(element_from_value<element_type>(helper.get(instance.rational_integer(i)), instance));
+		}
+		return instance.add_foreign_object(std::make_unique<typed_array<element_type>>(std::move(elements)));
+	}
+
+	if constexpr (std::is_same_v<element_type, uint8_t>) {
+		if (args[0].check_type(HulaScript::instance::value::vtype::STRING)) {
+			std::string str = args[0].str(instance);
+			return instance.add_foreign_object(std::make_unique<buffer_object>(std::vector<uint8_t>(str.begin(), str.end())));
+		}
+	}
+
+	return instance.add_foreign_object(std::make_unique<typed_array<element_type>>(args[0].index(0, INT64_MAX, instance)));
+}
+
+template class HulaUtils::typed_array<uint8_t>;
+template class HulaUtils::typed_array<double>;
+template class HulaUtils::typed_array<int64_t>;
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::Buffer(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	return make_typed_array<uint8_t>(args, instance);
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::Float64Array(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	return make_typed_array<double>(args, instance);
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::Int64Array(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	return make_typed_array<int64_t>(args, instance);
+}
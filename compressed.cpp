@@ -0,0 +1,451 @@
+#include "HulaUtils.hpp"
+#include <cstring>
+#include <climits>
+#include <sstream>
+
+#ifdef HULAUTILS_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HULAUTILS_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace HulaUtils;
+
+class HulaUtils::compressed_stream {
+public:
+	virtual ~compressed_stream() = default;
+
+	//returns the number of decompressed bytes, 0 at the end of the stream, or -1 on corrupt input
+	virtual int64_t read(char* out, size_t size) = 0;
+	virtual bool write(const char* data, size_t size) = 0;
+
+	//flushes any pending compressed output; the stream is unusable afterwards
+	virtual bool finish() = 0;
+};
+
+#ifdef HULAUTILS_HAS_ZLIB
+class gzip_stream : public compressed_stream {
+private:
+	gzFile file;
+
+public:
+	gzip_stream(gzFile file) : file(file) {
+		gzbuffer(file, compressed_file_object::block_size);
+	}
+
+	~gzip_stream() {
+		finish();
+	}
+
+	int64_t read(char* out, size_t size) override {
+		int result = gzread(file, out, static_cast<unsigned int>(std::min<size_t>(size, INT_MAX)));
+		if (result == 0) {
+			//zlib reports a truncated member as a plain end of file plus Z_BUF_ERROR
+			int error;
+			gzerror(file, &error);
+			return error == Z_OK ? 0 : -1;
+		}
+		return result < 0 ? -1 : result;
+	}
+
+	bool write(const char* data, size_t size) override {
+		while (size > 0) {
+			unsigned int chunk = static_cast<unsigned int>(std::min<size_t>(size, INT_MAX));
+			if (gzwrite(file, data, chunk) == 0) {
+				return false;
+			}
+			data += chunk;
+			size -= chunk;
+		}
+		return true;
+	}
+
+	bool finish() override {
+		if (file == NULL) {
+			return true;
+		}
+		bool success = gzclose(file) == Z_OK;
+		file = NULL;
+		return success;
+	}
+};
+#endif
+
+#ifdef HULAUTILS_HAS_ZSTD
+class zstd_stream : public compressed_stream {
+private:
+	FILE* file;
+	ZSTD_DCtx* decompressor = NULL;
+	ZSTD_CCtx* compressor = NULL;
+
+	std::vector<char> io_buffer;
+	ZSTD_inBuffer input = { NULL, 0, 0 };
+
+	//zero once the last frame read has been fully decoded, so EOF there isn't truncation
+	size_t frame_remaining = 0;
+
+public:
+	zstd_stream(FILE* file, bool writing, int level) : file(file), io_buffer(writing ? ZSTD_CStreamOutSize() : ZSTD_DStreamInSize()) {
+		if (writing) {
+			compressor = ZSTD_createCCtx();
+			ZSTD_CCtx_setParameter(compressor, ZSTD_c_compressionLevel, level);
+		}
+		else {
+			decompressor = ZSTD_createDCtx();
+		}
+	}
+
+	~zstd_stream() {
+		finish();
+	}
+
+	int64_t read(char* out, size_t size) override {
+		ZSTD_outBuffer output = { out, size, 0 };
+		while (output.pos == 0) {
+			if (input.pos == input.size) {
+				size_t got = std::fread(io_buffer.data(), 1, io_buffer.size(), file);
+				if (got == 0) {
+					return (std::ferror(file) || frame_remaining != 0) ? -1 : 0;
+				}
+				input = { io_buffer.data(), got, 0 };
+			}
+
+			size_t result = ZSTD_decompressStream(decompressor, &output, &input);
+			if (ZSTD_isError(result)) {
+				return -1;
+			}
+			frame_remaining = result;
+		}
+		return static_cast<int64_t>(output.pos);
+	}
+
+	bool write(const char* data, size_t size) override {
+		ZSTD_inBuffer pending = { data, size, 0 };
+		while (pending.pos < pending.size) {
+			ZSTD_outBuffer output = { io_buffer.data(), io_buffer.size(), 0 };
+			if (ZSTD_isError(ZSTD_compressStream2(compressor, &output, &pending, ZSTD_e_continue))) {
+				return false;
+			}
+			if (std::fwrite(io_buffer.data(), 1, output.pos, file) != output.pos) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool finish() override {
+		if (file == NULL) {
+			return true;
+		}
+
+		bool success = true;
+		if (compressor != NULL) {
+			ZSTD_inBuffer empty = { NULL, 0, 0 };
+			size_t remaining;
+			do {
+				ZSTD_outBuffer output = { io_buffer.data(), io_buffer.size(), 0 };
+				remaining = ZSTD_compressStream2(compressor, &output, &empty, ZSTD_e_end);
+				if (ZSTD_isError(remaining) || std::fwrite(io_buffer.data(), 1, output.pos, file) != output.pos) {
+					success = false;
+					break;
+				}
+			} while (remaining != 0);
+			ZSTD_freeCCtx(compressor);
+			compressor = NULL;
+		}
+		if (decompressor != NULL) {
+			ZSTD_freeDCtx(decompressor);
+			decompressor = NULL;
+		}
+
+		success = std::fclose(file) == 0 && success;
+		file = NULL;
+		return success;
+	}
+};
+#endif
+
+HulaUtils::compressed_file_object::compressed_file_object(std::unique_ptr<compressed_stream> stream, bool writing) : stream(std::move(stream)), writing(writing) {
+	if (!writing) {
+		read_buffer.resize(block_size);
+	}
+}
+
+HulaUtils::compressed_file_object::~compressed_file_object() = default;
+
+void HulaUtils::compressed_file_object::expect_usable(bool for_writing, HulaScript::instance& instance) {
+	if (stream == nullptr) {
+		instance.panic("File handle object is closed.");
+	}
+	if (for_writing != writing) {
+		instance.panic(writing ? "Compressed stream was opened for writing." : "Compressed stream was opened for reading.");
+	}
+}
+
+bool HulaUtils::compressed_file_object::fill_buffer(HulaScript::instance& instance) {
+	if (at_end) {
+		return false;
+	}
+
+	int64_t result = stream->read(read_buffer.data(), read_buffer.size());
+	if (result < 0) {
+		instance.panic("Decompression Error: Compressed stream is corrupt or truncated.");
+	}
+
+	buffer_start = 0;
+	buffer_end = static_cast<size_t>(result);
+	at_end = result == 0;
+	return !at_end;
+}
+
+size_t HulaUtils::compressed_file_object::read_bytes(char* out, size_t size, HulaScript::instance& instance) {
+	size_t total = 0;
+	while (total < size) {
+		if (buffer_start == buffer_end && !fill_buffer(instance)) {
+			break;
+		}
+
+		size_t chunk = std::min(size - total, buffer_end - buffer_start);
+		std::memcpy(out + total, read_buffer.data() + buffer_start, chunk);
+		buffer_start += chunk;
+		total += chunk;
+	}
+	return total;
+}
+
+bool HulaUtils::compressed_file_object::write_bytes(const char* data, size_t size) {
+	return stream->write(data, size);
+}
+
+HulaScript::instance::value HulaUtils::compressed_file_object::read_line(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(0);
+	expect_usable(false, instance);
+
+	std::string line;
+	for (;;) {
+		if (buffer_start == buffer_end && !fill_buffer(instance)) {
+			break;
+		}
+
+		const char* begin = read_buffer.data() + buffer_start;
+		const char* newline = static_cast<const char*>(std::memchr(begin, '\n', buffer_end - buffer_start));
+		if (newline != nullptr) {
+			line.append(begin, newline);
+			buffer_start += (newline - begin) + 1;
+			break;
+		}
+		line.append(begin, buffer_end - buffer_start);
+		buffer_start = buffer_end;
+	}
+	return instance.make_string(line);
+}
+
+HulaScript::instance::value HulaUtils::compressed_file_object::read_all_lines(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(0);
+	expect_usable(false, instance);
+
+	std::vector<HulaScript::instance::value> lines;
+	std::string line;
+	for (;;) {
+		if (buffer_start == buffer_end && !fill_buffer(instance)) {
+			break;
+		}
+
+		const char* begin = read_buffer.data() + buffer_start;
+		const char* newline = static_cast<const char*>(std::memchr(begin, '\n', buffer_end - buffer_start));
+		if (newline == nullptr) {
+			line.append(begin, buffer_end - buffer_start);
+			buffer_start = buffer_end;
+			continue;
+		}
+
+		line.append(begin, newline);
+		buffer_start += (newline - begin) + 1;
+		lines.push_back(instance.make_string(line));
+		instance.temp_gc_protect(lines.back());
+		line.clear();
+	}
+	lines.push_back(instance.make_string(line));
+	instance.temp_gc_protect(lines.back());
+
+	auto result = instance.make_array(lines);
+	for (size_t i = 0; i < lines.size(); i++) {
+		instance.temp_gc_unprotect();
+	}
+	return result;
+}
+
+HulaScript::instance::value HulaUtils::compressed_file_object::read_to_end(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(0);
+	expect_usable(false, instance);
+
+	std::string contents(read_buffer.data() + buffer_start, buffer_end - buffer_start);
+	buffer_start = buffer_end;
+	while (fill_buffer(instance)) {
+		contents.append(read_buffer.data(), buffer_end);
+		buffer_start = buffer_end;
+	}
+	return instance.make_string(contents);
+}
+
+HulaScript::instance::value HulaUtils::compressed_file_object::write(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(1);
+	expect_usable(true, instance);
+
+	std::string str = instance.get_value_print_string(args[0]);
+	return HulaScript::instance::value(write_bytes(str.data(), str.size()));
+}
+
+HulaScript::instance::value HulaUtils::compressed_file_object::write_line(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(1);
+	expect_usable(true, instance);
+
+	std::string str = instance.get_value_print_string(args[0]);
+	str.push_back('\n');
+	return HulaScript::instance::value(write_bytes(str.data(), str.size()));
+}
+
+HulaScript::instance::value HulaUtils::compressed_file_object::read_into(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	if (args.size() < 1 || args.size() > 2) {
+		instance.panic("FFI Error: Function received wrong number of arguments.");
+	}
+	expect_usable(false, instance);
+
+	native_array& array = expect_native_array(args[0], instance);
+	size_t count = array.length();
+	if (args.size() == 2) {
+		count = args[1].index(0, array.length() + 1, instance);
+	}
+
+	size_t read = read_bytes(array.data_bytes(), count * array.element_size(), instance);
+	return instance.rational_integer(read / array.element_size());
+}
+
+HulaScript::instance::value HulaUtils::compressed_file_object::write_from(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	if (args.size() < 1 || args.size() > 2) {
+		instance.panic("FFI Error: Function received wrong number of arguments.");
+	}
+	expect_usable(true, instance);
+
+	native_array& array = expect_native_array(args[0], instance);
+	size_t count = array.length();
+	if (args.size() == 2) {
+		count = args[1].index(0, array.length() + 1, instance);
+	}
+
+	return HulaScript::instance::value(write_bytes(array.data_bytes(), count * array.element_size()));
+}
+
+HulaScript::instance::value HulaUtils::compressed_file_object::close(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(0);
+	if (stream == nullptr) {
+		instance.panic("File handle object is closed.");
+		return HulaScript::instance::value(); //unreachable
+	}
+
+	bool success = stream->finish();
+	stream.reset();
+	read_buffer.clear();
+	read_buffer.shrink_to_fit();
+
+	return HulaScript::instance::value(success);
+}
+
+enum class compression_format {
+	GZIP,
+	ZSTD
+};
+
+static bool ends_with(const std::string& str, const char* suffix) {
+	size_t length = std::strlen(suffix);
+	return str.size() >= length && str.compare(str.size() - length, length, suffix) == 0;
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::openCompressed(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(2);
+
+	std::string path = args[0].str(instance);
+	std::string mode = args[1].str(instance);
+
+	//mode is r, w or a, optionally followed by a compression level digit
+	int level = -1;
+	if (mode.empty() || (mode[0] != 'r' && mode[0] != 'w' && mode[0] != 'a') || mode.size() > 2 || (mode.size() == 2 && (mode[1] < '0' || mode[1] > '9'))) {
+		std::stringstream ss;
+		ss << "Unknown compressed file mode \"" << mode << "\". Expected r, w or a, optionally followed by a level from 0 to 9.";
+		instance.panic(ss.str());
+	}
+	if (mode.size() == 2) {
+		level = mode[1] - '0';
+	}
+	bool writing = mode[0] != 'r';
+
+	//readers sniff the magic number; writers go by the file extension
+	compression_format format = compression_format::GZIP;
+	if (writing) {
+		if (ends_with(path, ".zst") || ends_with(path, ".zstd")) {
+			format = compression_format::ZSTD;
+		}
+	}
+	else {
+		FILE* probe = std::fopen(path.c_str(), "rb");
+		if (probe == NULL) {
+			return HulaScript::instance::value();
+		}
+		unsigned char magic[4] = { 0 };
+		size_t got = std::fread(magic, 1, sizeof(magic), probe);
+		std::fclose(probe);
+
+		if (got == 4 && magic[0] == 0x28 && magic[1] == 0xB5 && magic[2] == 0x2F && magic[3] == 0xFD) {
+			format = compression_format::ZSTD;
+		}
+	}
+
+	std::unique_ptr<compressed_stream> stream;
+	switch (format)
+	{
+	case compression_format::GZIP: {
+#ifdef HULAUTILS_HAS_ZLIB
+		std::string gz_mode(1, mode[0]);
+		gz_mode.push_back('b');
+		if (level >= 0) {
+			gz_mode.push_back('0' + level);
+		}
+
+		gzFile file = gzopen(path.c_str(), gz_mode.c_str());
+		if (file == NULL) {
+			return HulaScript::instance::value();
+		}
+		stream = std::make_unique<gzip_stream>(file);
+#else
+		instance.panic("openCompressed: HulaUtils was built without zlib, so gzip streams are unavailable.");
+#endif
+		break;
+	}
+	case compression_format::ZSTD: {
+#ifdef HULAUTILS_HAS_ZSTD
+		const char* file_mode = mode[0] == 'r' ? "rb" : (mode[0] == 'w' ? "wb" : "ab");
+		FILE* file = std::fopen(path.c_str(), file_mode);
+		if (file == NULL) {
+			return HulaScript::instance::value();
+		}
+		stream = std::make_unique<zstd_stream>(file, writing, level >= 0 ? level : ZSTD_CLEVEL_DEFAULT);
+#else
+		instance.panic("openCompressed: HulaUtils was built without libzstd, so zstd streams are unavailable.");
+#endif
+		break;
+	}
+	}
+
+	return instance.add_foreign_object(std::make_unique<compressed_file_object>(std::move(stream), writing));
+}
@@ -0,0 +1,246 @@
+#include "HulaUtils.hpp"
+#include <atomic>
+#include <cerrno>
+#include <filesystem>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+#endif
+
+using namespace HulaUtils;
+
+#ifdef __linux__
+//sendfile and then plain read/write, for filesystems or kernels without copy_file_range
+static bool copy_descriptor_fallback(int from, int to, off_t offset, off_t size) {
+	bool use_sendfile = true;
+	while (offset < size) {
+		if (use_sendfile) {
+			ssize_t sent = sendfile(to, from, &offset, size - offset);
+			if (sent > 0) {
+				continue;
+			}
+			else if (sent < 0 && errno == EINTR) {
+				continue;
+			}
+			else if (sent < 0 && (errno == EINVAL || errno == ENOSYS)) {
+				use_sendfile = false;
+				continue;
+			}
+			//sendfile returns 0 once the source hits EOF, which means it shrank under us
+			return false;
+		}
+
+		char buffer[64 * 1024];
+		ssize_t got = pread(from, buffer, sizeof(buffer), offset);
+		if (got < 0 && errno == EINTR) {
+			continue;
+		}
+		else if (got <= 0) {
+			return false;
+		}
+		for (ssize_t written = 0; written < got;) {
+			ssize_t result = write(to, buffer + written, got - written);
+			if (result < 0 && errno == EINTR) {
+				continue;
+			}
+			else if (result <= 0) {
+				return false;
+			}
+			written += result;
+		}
+		offset += got;
+	}
+	return true;
+}
+#endif
+
+bool HulaUtils::copy_file_contents(const std::string& from, const std::string& to, bool overwrite) {
+#ifdef __linux__
+	int source = open(from.c_str(), O_RDONLY | O_CLOEXEC);
+	if (source < 0) {
+		return false;
+	}
+	struct stat info;
+	if (fstat(source, &info) != 0 || !S_ISREG(info.st_mode)) {
+		close(source);
+		return false;
+	}
+
+	//truncating the destination before this check would wipe a source copied onto itself or one of its hard links
+	struct stat existing;
+	if (stat(to.c_str(), &existing) == 0 && existing.st_dev == info.st_dev && existing.st_ino == info.st_ino) {
+		close(source);
+		return false;
+	}
+
+	int destination = open(to.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (overwrite ? 0 : O_EXCL), info.st_mode & 07777);
+	if (destination < 0) {
+		close(source);
+		return false;
+	}
+	struct stat opened;
+	if (fstat(destination, &opened) != 0 || (opened.st_dev == info.st_dev && opened.st_ino == info.st_ino) || ftruncate(destination, 0) != 0) {
+		close(source);
+		close(destination);
+		return false;
+	}
+
+	bool success = false;
+#ifdef FICLONE
+	//a reflink shares the source's extents, so nothing is copied at all on btrfs/XFS
+	success = ioctl(destination, FICLONE, source) == 0;
+#endif
+	if (!success) {
+		off_t offset = 0;
+		success = true;
+		while (offset < info.st_size) {
+			ssize_t copied = copy_file_range(source, &offset, destination, NULL, info.st_size - offset, 0);
+			if (copied < 0 && errno == EINTR) {
+				continue;
+			}
+			else if (copied < 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP) && offset == 0) {
+				success = copy_descriptor_fallback(source, destination, 0, info.st_size);
+				offset = success ? info.st_size : 0;
+				break;
+			}
+			else if (copied <= 0) {
+				//the source shrank under us, or a real I/O error
+				success = false;
+				break;
+			}
+		}
+		success = success && offset == info.st_size;
+	}
+	success = fchmod(destination, info.st_mode & 07777) == 0 && success;
+
+	close(source);
+	success = close(destination) == 0 && success;
+	if (!success) {
+		unlink(to.c_str());
+	}
+	return success;
+#else
+	std::error_code error;
+	auto options = overwrite ? std::filesystem::copy_options::overwrite_existing : std::filesystem::copy_options::none;
+	return std::filesystem::copy_file(from, to, options, error) && !error;
+#endif
+}
+
+//directories and symlinks are recreated in order on the caller's thread; regular files copy on the worker pool
+//complete is cleared if any entry failed to copy or was skipped (special files, unreadable entries)
+static int64_t copy_tree(const std::filesystem::path& from, const std::filesystem::path& to, bool overwrite, bool& complete) {
+	complete = false;
+	std::error_code error;
+	std::filesystem::create_directories(to, error);
+	if (error) {
+		return -1;
+	}
+
+	std::vector<std::pair<std::string, std::string>> files;
+	bool entries_complete = true;
+	for (auto it = std::filesystem::recursive_directory_iterator(from, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+		//lexical, since relative() would resolve a symlink entry to its target
+		std::filesystem::path target = to / it->path().lexically_relative(from);
+
+		std::error_code entry_error;
+		if (it->is_symlink(entry_error)) {
+			if (overwrite) {
+				std::filesystem::remove(target, entry_error);
+			}
+			std::filesystem::copy_symlink(it->path(), target, entry_error);
+		}
+		else if (it->is_directory(entry_error)) {
+			std::filesystem::create_directory(target, entry_error);
+		}
+		else if (it->is_regular_file(entry_error)) {
+			files.push_back({ it->path().string(), target.string() });
+		}
+		else {
+			entries_complete = false;
+		}
+		if (entry_error) {
+			entries_complete = false;
+		}
+	}
+	if (error) {
+		return -1;
+	}
+
+	std::atomic<int64_t> copied(0);
+	worker_pool().parallel_for(files.size(), [&files, &copied, overwrite](size_t i) {
+		if (copy_file_contents(files[i].first, files[i].second, overwrite)) {
+			copied.fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+	complete = entries_complete && copied.load() == static_cast<int64_t>(files.size());
+	return copied.load();
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::copyFile(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	bool overwrite = true;
+	if (args.size() == 3) {
+		overwrite = args[2].boolean(instance);
+	}
+	else {
+		HULASCRIPT_EXPECT_ARGS(2);
+	}
+
+	return HulaScript::instance::value(copy_file_contents(args[0].str(instance), args[1].str(instance), overwrite));
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::copyTree(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	bool overwrite = true;
+	if (args.size() == 3) {
+		overwrite = args[2].boolean(instance);
+	}
+	else {
+		HULASCRIPT_EXPECT_ARGS(2);
+	}
+
+	bool complete;
+	int64_t copied = copy_tree(args[0].str(instance), args[1].str(instance), overwrite, complete);
+	if (copied < 0) {
+		return HulaScript::instance::value();
+	}
+	return instance.rational_integer(copied);
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::moveFile(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(2);
+
+	std::filesystem::path from = args[0].str(instance);
+	std::filesystem::path to = args[1].str(instance);
+
+	std::error_code error;
+	std::filesystem::rename(from, to, error);
+	if (!error) {
+		return HulaScript::instance::value(true);
+	}
+	else if (error != std::errc::cross_device_link) {
+		return HulaScript::instance::value(false);
+	}
+
+	//rename can't cross filesystems, so copy and then remove the source
+	bool success;
+	if (std::filesystem::is_directory(from, error)) {
+		//the source only goes away once every entry made it across
+		bool complete;
+		success = copy_tree(from, to, true, complete) >= 0 && complete;
+	}
+	else {
+		success = copy_file_contents(from.string(), to.string(), true);
+	}
+	if (success) {
+		std::filesystem::remove_all(from, error);
+		success = !error;
+	}
+	return HulaScript::instance::value(success);
+}
@@ -0,0 +1,410 @@
+#include "HulaUtils.hpp"
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+using namespace HulaUtils;
+
+static constexpr HulaScript::interned_key delimiter_key("delimiter");
+static constexpr HulaScript::interned_key header_key("header");
+static constexpr HulaScript::interned_key columns_key("columns");
+static constexpr HulaScript::interned_key infer_types_key("inferTypes");
+
+static std::string decode_field(const csv_reader_object::field& current) {
+	if (!current.escaped) {
+		return std::string(current.raw);
+	}
+
+	std::string decoded;
+	decoded.reserve(current.raw.size());
+	for (size_t i = 0; i < current.raw.size(); i++) {
+		decoded.push_back(current.raw[i]);
+		if (current.raw[i] == '\"') {
+			i++;
+		}
+	}
+	return decoded;
+}
+
+//unquoted fields that are entirely an integer or a number; quoted fields always stay strings
+static bool parse_integer_field(const csv_reader_object::field& current, int64_t& integer) {
+	const char* end = current.raw.data() + current.raw.size();
+	auto result = std::from_chars(current.raw.data(), end, integer);
+	return !current.quoted && !current.raw.empty() && result.ec == std::errc() && result.ptr == end;
+}
+
+static bool parse_number_field(const csv_reader_object::field& current, double& number) {
+	//from_chars also reads nan, inf and infinity in any case, which would turn words like "Nan" into numbers
+	size_t first = !current.raw.empty() && current.raw[0] == '-' ? 1 : 0;
+	if (first >= current.raw.size() || !(std::isdigit(static_cast<unsigned char>(current.raw[first])) || current.raw[first] == '.')) {
+		return false;
+	}
+
+	const char* end = current.raw.data() + current.raw.size();
+	auto result = std::from_chars(current.raw.data(), end, number);
+	return !current.quoted && !current.raw.empty() && result.ec == std::errc() && result.ptr == end;
+}
+
+bool HulaUtils::csv_reader_object::read_record(std::vector<field>& out, bool all_columns) {
+	std::string_view data = contents->view();
+	const char* p = data.data() + position;
+	const char* end = data.data() + data.size();
+
+	//blank lines separate nothing
+	while (p < end && (*p == '\n' || *p == '\r')) {
+		p++;
+	}
+	if (p == end) {
+		position = data.size();
+		return false;
+	}
+
+	if (!all_columns) {
+		std::fill(out.begin(), out.end(), field{ std::string_view(), false, false });
+	}
+
+	size_t column = 0;
+	for (;;) {
+		field current = { std::string_view(), false, false };
+		if (p < end && *p == '\"') {
+			//quoted fields may hold delimiters and newlines; a doubled quote is a literal one
+			const char* start = ++p;
+			for (;;) {
+				const char* quote = static_cast<const char*>(std::memchr(p, '\"', end - p));
+				if (quote == nullptr) {
+					p = end;
+					break;
+				}
+				else if (quote + 1 < end && quote[1] == '\"') {
+					current.escaped = true;
+					p = quote + 2;
+					continue;
+				}
+				p = quote;
+				break;
+			}
+			current.raw = std::string_view(start, p - start);
+			current.quoted = true;
+			if (p < end) {
+				p++;
+			}
+		}
+		else {
+			const char* start = p;
+			while (p < end && *p != delimiter && *p != '\n' && *p != '\r') {
+				p++;
+			}
+			current.raw = std::string_view(start, p - start);
+		}
+
+		//anything between a closing quote and the delimiter is dropped
+		while (p < end && *p != delimiter && *p != '\n' && *p != '\r') {
+			p++;
+		}
+
+		if (all_columns) {
+			out.push_back(current);
+		}
+		else if (column < column_slots.size() && column_slots[column] >= 0) {
+			out[column_slots[column]] = current;
+		}
+		column++;
+
+		if (p < end && *p == delimiter) {
+			p++;
+			continue;
+		}
+		if (p < end && *p == '\r') {
+			p++;
+		}
+		if (p < end && *p == '\n') {
+			p++;
+		}
+		break;
+	}
+
+	position = p - data.data();
+	return true;
+}
+
+void HulaUtils::csv_reader_object::select_columns(bool has_header, std::optional<std::vector<HulaScript::instance::value>> selection, HulaScript::instance& instance) {
+	std::vector<field> first;
+	size_t start = position;
+	read_record(first, true);
+	if (!has_header) {
+		position = start;
+	}
+
+	std::vector<std::string> source_names;
+	source_names.reserve(first.size());
+	for (size_t i = 0; i < first.size(); i++) {
+		source_names.push_back(has_header ? decode_field(first[i]) : std::to_string(i));
+	}
+
+	column_slots.assign(source_names.size(), -1);
+	if (!selection.has_value()) {
+		for (size_t i = 0; i < source_names.size(); i++) {
+			column_slots[i] = static_cast<int32_t>(i);
+		}
+		names = std::move(source_names);
+		return;
+	}
+
+	for (auto& selected : selection.value()) {
+		size_t index;
+		if (selected.check_type(HulaScript::instance::value::vtype::STRING)) {
+			std::string name = selected.str(instance);
+			auto it = std::find(source_names.begin(), source_names.end(), name);
+			if (it == source_names.end()) {
+				std::stringstream ss;
+				ss << "CSV Error: No column named \"" << name << "\".";
+				instance.panic(ss.str());
+			}
+			index = it - source_names.begin();
+		}
+		else {
+			index = selected.index(0, source_names.size(), instance);
+		}
+
+		if (column_slots[index] < 0) {
+			column_slots[index] = static_cast<int32_t>(names.size());
+			names.push_back(source_names[index]);
+		}
+	}
+}
+
+HulaScript::instance::value HulaUtils::csv_reader_object::field_value(const field& current, HulaScript::instance& instance) const {
+	if (infer_types && !current.quoted) {
+		if (current.raw.empty()) {
+			return HulaScript::instance::value();
+		}
+
+		int64_t integer;
+		if (parse_integer_field(current, integer)) {
+			return instance.rational_integer(integer);
+		}
+		double number;
+		if (parse_number_field(current, number)) {
+			return HulaScript::instance::value(number);
+		}
+	}
+	return instance.make_string(decode_field(current));
+}
+
+HulaScript::instance::value HulaUtils::csv_reader_object::make_row(const std::vector<field>& fields, HulaScript::instance& instance) const {
+	std::vector<HulaScript::instance::value> row;
+	row.reserve(fields.size());
+	for (auto& current : fields) {
+		row.push_back(field_value(current, instance));
+		instance.temp_gc_protect(row.back());
+	}
+
+	auto result = instance.make_array(row);
+	for (size_t i = 0; i < row.size(); i++) {
+		instance.temp_gc_unprotect();
+	}
+	return result;
+}
+
+//a column that is all integers becomes an Int64Array and one that is all numbers a Float64Array (blanks read as NaN); anything else is a plain array
+HulaScript::instance::value HulaUtils::csv_reader_object::make_column(const std::vector<field>& fields, HulaScript::instance& instance) const {
+	if (infer_types) {
+		bool all_integers = true;
+		bool all_numbers = true;
+		for (auto& current : fields) {
+			int64_t integer;
+			double number;
+			if (all_integers && parse_integer_field(current, integer)) {
+				continue;
+			}
+			all_integers = false;
+			if (!(current.raw.empty() && !current.quoted) && !parse_number_field(current, number)) {
+				all_numbers = false;
+				break;
+			}
+		}
+
+		if (all_integers) {
+			std::vector<int64_t> elements(fields.size());
+			for (size_t i = 0; i < fields.size(); i++) {
+				parse_integer_field(fields[i], elements[i]);
+			}
+			return instance.add_foreign_object(std::make_unique<int64_array>(std::move(elements)));
+		}
+		else if (all_numbers) {
+			std::vector<double> elements(fields.size());
+			for (size_t i = 0; i < fields.size(); i++) {
+				if (!parse_number_field(fields[i], elements[i])) {
+					elements[i] = NAN;
+				}
+			}
+			return instance.add_foreign_object(std::make_unique<float64_array>(std::move(elements)));
+		}
+	}
+	return make_row(fields, instance);
+}
+
+void HulaUtils::csv_reader_object::expect_open(HulaScript::instance& instance) const {
+	if (!contents.has_value()) {
+		instance.panic("CSVReader object is closed.");
+	}
+}
+
+HulaScript::instance::value HulaUtils::csv_reader_object::get_columns(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(0);
+
+	std::vector<HulaScript::instance::value> column_names;
+	column_names.reserve(names.size());
+	for (auto& name : names) {
+		column_names.push_back(instance.make_string(name));
+		instance.temp_gc_protect(column_names.back());
+	}
+
+	auto result = instance.make_array(column_names);
+	for (size_t i = 0; i < column_names.size(); i++) {
+		instance.temp_gc_unprotect();
+	}
+	return result;
+}
+
+HulaScript::instance::value HulaUtils::csv_reader_object::read_row(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(0);
+	expect_open(instance);
+
+	std::vector<field> fields(names.size());
+	if (!read_record(fields, false)) {
+		return HulaScript::instance::value();
+	}
+	return make_row(fields, instance);
+}
+
+HulaScript::instance::value HulaUtils::csv_reader_object::read_rows(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	size_t max_rows = SIZE_MAX;
+	if (args.size() == 1) {
+		max_rows = args[0].size(instance);
+	}
+	else {
+		HULASCRIPT_EXPECT_ARGS(0);
+	}
+	expect_open(instance);
+
+	std::vector<HulaScript::instance::value> rows;
+	std::vector<field> fields(names.size());
+	while (rows.size() < max_rows && read_record(fields, false)) {
+		rows.push_back(make_row(fields, instance));
+		instance.temp_gc_protect(rows.back());
+	}
+
+	auto result = instance.make_array(rows);
+	for (size_t i = 0; i < rows.size(); i++) {
+		instance.temp_gc_unprotect();
+	}
+	return result;
+}
+
+HulaScript::instance::value HulaUtils::csv_reader_object::read_batch(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(1);
+	size_t max_rows = args[0].size(instance);
+	expect_open(instance);
+
+	//fields stay as views into the file until each column is converted in one go
+	std::vector<std::vector<field>> columns(names.size());
+	std::vector<field> fields(names.size());
+	size_t row_count = 0;
+	while (row_count < max_rows && read_record(fields, false)) {
+		for (size_t i = 0; i < fields.size(); i++) {
+			columns[i].push_back(fields[i]);
+		}
+		row_count++;
+	}
+	if (row_count == 0) {
+		return HulaScript::instance::value();
+	}
+
+	std::vector<std::pair<std::string, HulaScript::instance::value>> batch;
+	batch.reserve(names.size());
+	for (size_t i = 0; i < names.size(); i++) {
+		batch.push_back(std::make_pair(names[i], make_column(columns[i], instance)));
+		instance.temp_gc_protect(batch.back().second);
+	}
+
+	auto result = instance.make_table_obj(batch);
+	for (size_t i = 0; i < batch.size(); i++) {
+		instance.temp_gc_unprotect();
+	}
+	return result;
+}
+
+HulaScript::instance::value HulaUtils::csv_reader_object::close(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(0);
+	expect_open(instance);
+
+	contents.reset();
+	return HulaScript::instance::value();
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::CSVReader(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	if (args.size() != 2) {
+		HULASCRIPT_EXPECT_ARGS(1);
+	}
+
+	std::string path = args[0].str(instance);
+	char delimiter = ',';
+	if (path.ends_with(".tsv") || path.ends_with(".tab")) {
+		delimiter = '\t';
+	}
+	bool has_header = true;
+	bool infer_types = true;
+	std::optional<std::vector<HulaScript::instance::value>> selection;
+
+	if (args.size() == 2) {
+		HulaScript::ffi_table_helper options(args[1], instance);
+
+		auto delimiter_value = options.get(delimiter_key);
+		if (!delimiter_value.check_type(HulaScript::instance::value::vtype::NIL)) {
+			std::string delimiter_str = delimiter_value.str(instance);
+			if (delimiter_str.size() != 1 || delimiter_str[0] == '\"' || delimiter_str[0] == '\n' || delimiter_str[0] == '\r') {
+				instance.panic("CSV Error: The delimiter must be a single character other than a quote or newline.");
+			}
+			delimiter = delimiter_str[0];
+		}
+
+		auto header_value = options.get(header_key);
+		if (!header_value.check_type(HulaScript::instance::value::vtype::NIL)) {
+			has_header = header_value.boolean(instance);
+		}
+
+		auto infer_value = options.get(infer_types_key);
+		if (!infer_value.check_type(HulaScript::instance::value::vtype::NIL)) {
+			infer_types = infer_value.boolean(instance);
+		}
+
+		auto columns_value = options.get(columns_key);
+		if (!columns_value.check_type(HulaScript::instance::value::vtype::NIL)) {
+			HulaScript::ffi_table_helper columns_helper(columns_value, instance);
+			size_t count = columns_helper.get_size();
+			selection.emplace();
+			selection->reserve(count);
+			for (size_t i = 0; i < count; i++) {
+				selection->push_back(columns_helper.get(instance.rational_integer(i)));
+			}
+		}
+	}
+
+	auto contents = file_contents::load(path);
+	if (!contents.has_value()) {
+		return HulaScript::instance::value();
+	}
+
+	auto reader = std::make_unique<csv_reader_object>(std::move(contents.value()), delimiter, infer_types);
+	reader->select_columns(has_header, selection, instance);
+	return instance.add_foreign_object(std::move(reader));
+}
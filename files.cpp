@@ -0,0 +1,446 @@
+#include "HulaUtils.hpp"
+#include <atomic>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <regex>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+using namespace HulaUtils;
+
+static void close_descriptor(int fd) {
+#ifdef _WIN32
+	_close(fd);
+#else
+	close(fd);
+#endif
+}
+
+//reads size_hint bytes, or until EOF when the size isn't known (pipes, procfs)
+static bool read_descriptor(int fd, size_t size_hint, std::string& out) {
+	out.resize(size_hint > 0 ? size_hint : 4096);
+
+	size_t total = 0;
+	for (;;) {
+		if (total == out.size()) {
+			if (size_hint > 0) {
+				break;
+			}
+			out.resize(out.size() * 2);
+		}
+
+#ifdef _WIN32
+		int result = _read(fd, out.data() + total, static_cast<unsigned int>(std::min<size_t>(out.size() - total, 1u << 30)));
+#else
+		ssize_t result = read(fd, out.data() + total, out.size() - total);
+#endif
+		if (result < 0 && errno == EINTR) {
+			continue;
+		}
+		else if (result < 0) {
+			return false;
+		}
+		else if (result == 0) {
+			break;
+		}
+		total += result;
+	}
+
+	out.resize(total);
+	return true;
+}
+
+std::optional<file_contents> HulaUtils::file_contents::load(const std::string& path) {
+#ifdef _WIN32
+	int fd = _open(path.c_str(), _O_RDONLY | _O_BINARY);
+	struct _stat64 info;
+	if (fd < 0 || _fstat64(fd, &info) != 0) {
+#else
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	struct stat info;
+	if (fd < 0 || fstat(fd, &info) != 0) {
+#endif
+		if (fd >= 0) {
+			close_descriptor(fd);
+		}
+		return std::nullopt;
+	}
+
+	file_contents contents;
+#ifndef _WIN32
+	if (S_ISREG(info.st_mode) && static_cast<size_t>(info.st_size) >= mmap_threshold) {
+		void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping != MAP_FAILED) {
+			madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+			close(fd);
+
+			contents.data = static_cast<const char*>(mapping);
+			contents.size = info.st_size;
+			contents.mapped = true;
+			return contents;
+		}
+	}
+#endif
+
+	bool success = read_descriptor(fd, info.st_size, contents.buffer);
+	close_descriptor(fd);
+	if (!success) {
+		return std::nullopt;
+	}
+
+	contents.data = contents.buffer.data();
+	contents.size = contents.buffer.size();
+	return contents;
+}
+
+HulaUtils::file_contents::file_contents(file_contents&& other) noexcept : size(other.size), mapped(other.mapped), buffer(std::move(other.buffer)) {
+	//a moved small string lives in our own storage now
+	data = mapped ? other.data : buffer.data();
+
+	other.data = nullptr;
+	other.size = 0;
+	other.mapped = false;
+}
+
+HulaUtils::file_contents::~file_contents() {
+#ifndef _WIN32
+	if (mapped) {
+		munmap(const_cast<char*>(data), size);
+	}
+#endif
+}
+
+std::string HulaUtils::file_contents::take_string() {
+	if (mapped) {
+		return std::string(data, size);
+	}
+
+	std::string taken = std::move(buffer);
+	data = nullptr;
+	size = 0;
+	return taken;
+}
+
+bool HulaUtils::write_whole_file(const std::string& path, const char* data, size_t size, bool atomic) {
+	static std::atomic<uint64_t> temp_counter(0);
+
+	std::string write_path = path;
+	if (atomic) {
+		//the temporary sits next to the target, so the final rename never crosses filesystems
+#ifdef _WIN32
+		write_path.append(".tmp-").append(std::to_string(_getpid()));
+#else
+		write_path.append(".tmp-").append(std::to_string(getpid()));
+#endif
+		write_path.append("-").append(std::to_string(temp_counter.fetch_add(1)));
+	}
+
+#ifdef _WIN32
+	int fd = _open(write_path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+	int fd = open(write_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+#endif
+	if (fd < 0) {
+		return false;
+	}
+
+	size_t total = 0;
+	while (total < size) {
+#ifdef _WIN32
+		int result = _write(fd, data + total, static_cast<unsigned int>(std::min<size_t>(size - total, 1u << 30)));
+#else
+		ssize_t result = write(fd, data + total, size - total);
+#endif
+		if (result < 0 && errno == EINTR) {
+			continue;
+		}
+		else if (result <= 0) {
+			break;
+		}
+		total += result;
+	}
+
+	bool success = total == size;
+	if (atomic && success) {
+#ifdef _WIN32
+		success = _commit(fd) == 0;
+#else
+		success = fsync(fd) == 0;
+#endif
+	}
+	close_descriptor(fd);
+
+	if (atomic) {
+		std::error_code error;
+		if (success) {
+			std::filesystem::rename(write_path, path, error);
+			success = !error;
+		}
+		if (!success) {
+			std::filesystem::remove(write_path, error);
+		}
+	}
+	return success;
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::readFile(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(1);
+
+	auto contents = file_contents::load(args[0].str(instance));
+	if (!contents.has_value()) {
+		return HulaScript::instance::value();
+	}
+	return instance.make_string(contents->take_string());
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::readLines(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(1);
+
+	auto contents = file_contents::load(args[0].str(instance));
+	if (!contents.has_value()) {
+		return HulaScript::instance::value();
+	}
+
+	//same splitting as file_object.readAllLines, including the final (possibly empty) line
+	std::string_view remaining = contents->view();
+	std::vector<HulaScript::instance::value> lines;
+	for (;;) {
+		size_t newline = remaining.find('\n');
+		if (newline == std::string_view::npos) {
+			lines.push_back(instance.make_string(std::string(remaining)));
+			instance.temp_gc_protect(lines.back());
+			break;
+		}
+		lines.push_back(instance.make_string(std::string(remaining.substr(0, newline))));
+		instance.temp_gc_protect(lines.back());
+		remaining.remove_prefix(newline + 1);
+	}
+
+	auto result = instance.make_array(lines);
+	for (size_t i = 0; i < lines.size(); i++) {
+		instance.temp_gc_unprotect();
+	}
+	return result;
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::writeFile(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	bool atomic = false;
+	if (args.size() == 3) {
+		atomic = args[2].boolean(instance);
+	}
+	else {
+		HULASCRIPT_EXPECT_ARGS(2);
+	}
+
+	std::string path = args[0].str(instance);
+	if (args[1].check_type(HulaScript::instance::value::vtype::FOREIGN_OBJECT)) {
+		native_array& array = expect_native_array(args[1], instance);
+		return HulaScript::instance::value(write_whole_file(path, array.data_bytes(), array.length() * array.element_size(), atomic));
+	}
+
+	std::string str = instance.get_value_print_string(args[1]);
+	return HulaScript::instance::value(write_whole_file(path, str.data(), str.size(), atomic));
+}
+
+static std::vector<std::string> expect_path_array(HulaScript::instance::value& value, HulaScript::instance& instance) {
+	HulaScript::ffi_table_helper helper(value, instance);
+	if (!helper.is_array()) {
+		instance.panic("Type Error: Expected an array of paths.");
+	}
+
+	size_t count = helper.get_size();
+	std::vector<std::string> paths;
+	paths.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		paths.push_back(helper.get(instance.rational_integer(i)).str(instance));
+	}
+	return paths;
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::readFiles(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(1);
+
+	std::vector<std::string> paths = expect_path_array(args[0], instance);
+	std::vector<std::optional<std::string>> contents(paths.size());
+	worker_pool().parallel_for(paths.size(), [&paths, &contents](size_t i) {
+		auto loaded = file_contents::load(paths[i]);
+		if (loaded.has_value()) {
+			contents[i] = loaded->take_string();
+		}
+	});
+
+	std::vector<HulaScript::instance::value> results;
+	results.reserve(paths.size());
+	for (auto& content : contents) {
+		results.push_back(content.has_value() ? instance.make_string(std::move(content.value())) : HulaScript::instance::value());
+		instance.temp_gc_protect(results.back());
+	}
+
+	auto result = instance.make_array(results);
+	for (size_t i = 0; i < results.size(); i++) {
+		instance.temp_gc_unprotect();
+	}
+	return result;
+}
+
+struct grep_match {
+	size_t line_number;
+	std::string text;
+};
+
+//memchr for the first byte, then memcmp the rest
+static size_t find_literal(std::string_view text, std::string_view needle, size_t from) {
+	if (needle.empty()) {
+		return from;
+	}
+
+	const char* cursor = text.data() + from;
+	const char* end = text.data() + text.size();
+	while (static_cast<size_t>(end - cursor) >= needle.size()) {
+		cursor = static_cast<const char*>(std::memchr(cursor, needle[0], (end - cursor) - needle.size() + 1));
+		if (cursor == nullptr) {
+			return std::string_view::npos;
+		}
+		if (std::memcmp(cursor + 1, needle.data() + 1, needle.size() - 1) == 0) {
+			return cursor - text.data();
+		}
+		cursor++;
+	}
+	return std::string_view::npos;
+}
+
+static void grep_literal(std::string_view text, std::string_view needle, size_t max_matches, std::vector<grep_match>& matches) {
+	size_t line_number = 1;
+	size_t counted_until = 0;
+	size_t position = 0;
+	while (matches.size() < max_matches && position < text.size()) {
+		size_t found = find_literal(text, needle, position);
+		if (found == std::string_view::npos) {
+			break;
+		}
+
+		line_number += std::count(text.begin() + counted_until, text.begin() + found, '\n');
+		counted_until = found;
+
+		size_t line_start = found == 0 ? std::string_view::npos : text.rfind('\n', found - 1);
+		line_start = line_start == std::string_view::npos ? 0 : line_start + 1;
+		size_t line_end = text.find('\n', found);
+		if (line_end == std::string_view::npos) {
+			line_end = text.size();
+		}
+
+		matches.push_back({ line_number, std::string(text.substr(line_start, line_end - line_start)) });
+		position = line_end + 1;
+	}
+}
+
+static void grep_regex(std::string_view text, const std::regex& pattern, size_t max_matches, std::vector<grep_match>& matches) {
+	size_t line_number = 1;
+	size_t position = 0;
+	while (matches.size() < max_matches && position < text.size()) {
+		size_t line_end = text.find('\n', position);
+		if (line_end == std::string_view::npos) {
+			line_end = text.size();
+		}
+
+		if (std::regex_search(text.data() + position, text.data() + line_end, pattern)) {
+			matches.push_back({ line_number, std::string(text.substr(position, line_end - position)) });
+		}
+		position = line_end + 1;
+		line_number++;
+	}
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::grepFiles(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	size_t max_matches = SIZE_MAX;
+	if (args.size() == 3) {
+		max_matches = args[2].index(0, INT64_MAX, instance);
+	}
+	else {
+		HULASCRIPT_EXPECT_ARGS(2);
+	}
+
+	std::vector<std::string> paths = expect_path_array(args[0], instance);
+	std::string pattern = args[1].str(instance);
+
+	//patterns without regex metacharacters take the memchr path
+	bool is_literal = pattern.find_first_of(".^$|()[]{}*+?\\") == std::string::npos;
+	std::optional<std::regex> compiled;
+	if (!is_literal) {
+		try {
+			compiled.emplace(pattern, std::regex::ECMAScript | std::regex::optimize);
+		}
+		catch (const std::regex_error& error) {
+			std::stringstream ss;
+			ss << "Grep Error: Invalid pattern \"" << pattern << "\": " << error.what();
+			instance.panic(ss.str());
+		}
+	}
+
+	std::vector<std::vector<grep_match>> file_matches(paths.size());
+	worker_pool().parallel_for(paths.size(), [&](size_t i) {
+		auto contents = file_contents::load(paths[i]);
+		if (!contents.has_value()) {
+			return;
+		}
+
+		if (is_literal) {
+			grep_literal(contents->view(), pattern, max_matches, file_matches[i]);
+		}
+		else {
+			grep_regex(contents->view(), compiled.value(), max_matches, file_matches[i]);
+		}
+	});
+
+	//protection is a stack, so paths and entries stay protected together until the array holds them
+	std::vector<HulaScript::instance::value> results;
+	size_t protected_count = 0;
+	for (size_t i = 0; i < paths.size() && results.size() < max_matches; i++) {
+		if (file_matches[i].empty()) {
+			continue;
+		}
+
+		auto path = instance.make_string(paths[i]);
+		instance.temp_gc_protect(path);
+		protected_count++;
+		for (grep_match& match : file_matches[i]) {
+			if (results.size() == max_matches) {
+				break;
+			}
+
+			auto text = instance.make_string(std::move(match.text));
+			instance.temp_gc_protect(text);
+			auto entry = instance.make_table_obj({
+				std::make_pair("path", path),
+				std::make_pair("line", instance.rational_integer(match.line_number)),
+				std::make_pair("text", text)
+			});
+			instance.temp_gc_unprotect();
+
+			results.push_back(entry);
+			instance.temp_gc_protect(entry);
+			protected_count++;
+		}
+	}
+
+	auto result = instance.make_array(results);
+	for (size_t i = 0; i < protected_count; i++) {
+		instance.temp_gc_unprotect();
+	}
+	return result;
+}
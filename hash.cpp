@@ -0,0 +1,521 @@
+#include "HulaUtils.hpp"
+#include <array>
+#include <cstring>
+#include <sstream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HULAUTILS_HASH_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HULAUTILS_CRC32C_SSE42
+#include <nmmintrin.h>
+#elif defined(_M_X64)
+#define HULAUTILS_CRC32C_SSE42
+#include <intrin.h>
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define HULAUTILS_CRC32C_ARM
+#include <arm_acle.h>
+#endif
+
+using namespace HulaUtils;
+
+static uint32_t read32(const uint8_t* p) {
+	uint32_t value;
+	std::memcpy(&value, p, sizeof(value));
+	if constexpr (std::endian::native == std::endian::big) {
+		value = ((value & 0xFF) << 24) | ((value & 0xFF00) << 8) | ((value >> 8) & 0xFF00) | (value >> 24);
+	}
+	return value;
+}
+
+static uint64_t read64(const uint8_t* p) {
+	return static_cast<uint64_t>(read32(p)) | (static_cast<uint64_t>(read32(p + 4)) << 32);
+}
+
+static uint64_t swap64(uint64_t value) {
+	value = ((value & 0x00FF00FF00FF00FFull) << 8) | ((value >> 8) & 0x00FF00FF00FF00FFull);
+	value = ((value & 0x0000FFFF0000FFFFull) << 16) | ((value >> 16) & 0x0000FFFF0000FFFFull);
+	return (value << 32) | (value >> 32);
+}
+
+//XXH3-64 with the default secret and seed 0, matching the reference XXH3_64bits
+namespace xxh3 {
+	static constexpr uint64_t prime32_1 = 0x9E3779B1u;
+	static constexpr uint64_t prime32_2 = 0x85EBCA77u;
+	static constexpr uint64_t prime32_3 = 0xC2B2AE3Du;
+	static constexpr uint64_t prime64_1 = 0x9E3779B185EBCA87ull;
+	static constexpr uint64_t prime64_2 = 0xC2B2AE3D27D4EB4Full;
+	static constexpr uint64_t prime64_3 = 0x165667B19E3779F9ull;
+	static constexpr uint64_t prime64_4 = 0x85EBCA77C2B2AE63ull;
+	static constexpr uint64_t prime64_5 = 0x27D4EB2F165667C5ull;
+	static constexpr uint64_t prime_mx1 = 0x165667919E3779F9ull;
+	static constexpr uint64_t prime_mx2 = 0x9FB21C651E98DF25ull;
+
+	static constexpr size_t stripe_length = 64;
+	static constexpr size_t secret_consume_rate = 8;
+
+	alignas(64) static constexpr uint8_t secret[192] = {
+		0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+		0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+		0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+		0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+		0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+		0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+		0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+		0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+		0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+		0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+		0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+		0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+	};
+
+	static uint64_t xxh64_avalanche(uint64_t hash) {
+		hash ^= hash >> 33;
+		hash *= prime64_2;
+		hash ^= hash >> 29;
+		hash *= prime64_3;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+	static uint64_t avalanche(uint64_t hash) {
+		hash ^= hash >> 37;
+		hash *= prime_mx1;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+	static uint64_t rrmxmx(uint64_t hash, uint64_t length) {
+		hash ^= std::rotl(hash, 49) ^ std::rotl(hash, 24);
+		hash *= prime_mx2;
+		hash ^= (hash >> 35) + length;
+		hash *= prime_mx2;
+		return hash ^ (hash >> 28);
+	}
+
+	static uint64_t mix16(const uint8_t* input, const uint8_t* key) {
+		return HulaScript::Hash::detail::mix(read64(input) ^ read64(key), read64(input + 8) ^ read64(key + 8));
+	}
+
+	static void accumulate_stripe(uint64_t* acc, const uint8_t* input, const uint8_t* key) {
+#ifdef HULAUTILS_HASH_SSE2
+		__m128i* xacc = reinterpret_cast<__m128i*>(acc);
+		for (size_t i = 0; i < 4; i++) {
+			__m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input) + i);
+			__m128i data_key = _mm_xor_si128(data, _mm_loadu_si128(reinterpret_cast<const __m128i*>(key) + i));
+			__m128i product = _mm_mul_epu32(data_key, _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1)));
+			__m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+			xacc[i] = _mm_add_epi64(product, _mm_add_epi64(xacc[i], swapped));
+		}
+#else
+		for (size_t i = 0; i < 8; i++) {
+			uint64_t data = read64(input + 8 * i);
+			uint64_t data_key = data ^ read64(key + 8 * i);
+			acc[i ^ 1] += data;
+			acc[i] += (data_key & 0xFFFFFFFF) * (data_key >> 32);
+		}
+#endif
+	}
+
+	static void scramble(uint64_t* acc, const uint8_t* key) {
+#ifdef HULAUTILS_HASH_SSE2
+		__m128i* xacc = reinterpret_cast<__m128i*>(acc);
+		const __m128i prime = _mm_set1_epi32(static_cast<int>(prime32_1));
+		for (size_t i = 0; i < 4; i++) {
+			__m128i mixed = _mm_xor_si128(xacc[i], _mm_srli_epi64(xacc[i], 47));
+			__m128i data_key = _mm_xor_si128(mixed, _mm_loadu_si128(reinterpret_cast<const __m128i*>(key) + i));
+			__m128i product_low = _mm_mul_epu32(data_key, prime);
+			__m128i product_high = _mm_mul_epu32(_mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+			xacc[i] = _mm_add_epi64(product_low, _mm_slli_epi64(product_high, 32));
+		}
+#else
+		for (size_t i = 0; i < 8; i++) {
+			uint64_t value = acc[i];
+			value ^= value >> 47;
+			value ^= read64(key + 8 * i);
+			acc[i] = value * prime32_1;
+		}
+#endif
+	}
+
+	static uint64_t hash_long(const uint8_t* input, size_t length) {
+		alignas(16) uint64_t acc[8] = { prime32_3, prime64_1, prime64_2, prime64_3, prime64_4, prime32_2, prime64_5, prime32_1 };
+
+		constexpr size_t stripes_per_block = (sizeof(secret) - stripe_length) / secret_consume_rate;
+		constexpr size_t block_length = stripe_length * stripes_per_block;
+		size_t block_count = (length - 1) / block_length;
+
+		for (size_t block = 0; block < block_count; block++) {
+			const uint8_t* block_input = input + block * block_length;
+			for (size_t stripe = 0; stripe < stripes_per_block; stripe++) {
+				accumulate_stripe(acc, block_input + stripe * stripe_length, secret + stripe * secret_consume_rate);
+			}
+			scramble(acc, secret + sizeof(secret) - stripe_length);
+		}
+
+		size_t stripe_count = ((length - 1) - block_length * block_count) / stripe_length;
+		const uint8_t* tail_input = input + block_count * block_length;
+		for (size_t stripe = 0; stripe < stripe_count; stripe++) {
+			accumulate_stripe(acc, tail_input + stripe * stripe_length, secret + stripe * secret_consume_rate);
+		}
+		accumulate_stripe(acc, input + length - stripe_length, secret + sizeof(secret) - stripe_length - 7);
+
+		uint64_t result = length * prime64_1;
+		for (size_t i = 0; i < 4; i++) {
+			result += HulaScript::Hash::detail::mix(acc[2 * i] ^ read64(secret + 11 + 16 * i), acc[2 * i + 1] ^ read64(secret + 11 + 16 * i + 8));
+		}
+		return avalanche(result);
+	}
+
+	static uint64_t hash(const uint8_t* input, size_t length) {
+		if (length == 0) {
+			return xxh64_avalanche(read64(secret + 56) ^ read64(secret + 64));
+		}
+		else if (length <= 3) {
+			uint32_t combined = (static_cast<uint32_t>(input[0]) << 16) | (static_cast<uint32_t>(input[length >> 1]) << 24) | input[length - 1] | (static_cast<uint32_t>(length) << 8);
+			return xxh64_avalanche(combined ^ static_cast<uint64_t>(read32(secret) ^ read32(secret + 4)));
+		}
+		else if (length <= 8) {
+			uint64_t combined = read32(input + length - 4) + (static_cast<uint64_t>(read32(input)) << 32);
+			return rrmxmx(combined ^ (read64(secret + 8) ^ read64(secret + 16)), length);
+		}
+		else if (length <= 16) {
+			uint64_t low = read64(input) ^ (read64(secret + 24) ^ read64(secret + 32));
+			uint64_t high = read64(input + length - 8) ^ (read64(secret + 40) ^ read64(secret + 48));
+			return avalanche(length + swap64(low) + high + HulaScript::Hash::detail::mix(low, high));
+		}
+		else if (length <= 128) {
+			uint64_t acc = length * prime64_1;
+			if (length > 32) {
+				if (length > 64) {
+					if (length > 96) {
+						acc += mix16(input + 48, secret + 96);
+						acc += mix16(input + length - 64, secret + 112);
+					}
+					acc += mix16(input + 32, secret + 64);
+					acc += mix16(input + length - 48, secret + 80);
+				}
+				acc += mix16(input + 16, secret + 32);
+				acc += mix16(input + length - 32, secret + 48);
+			}
+			acc += mix16(input, secret);
+			acc += mix16(input + length - 16, secret + 16);
+			return avalanche(acc);
+		}
+		else if (length <= 240) {
+			uint64_t acc = length * prime64_1;
+			size_t rounds = length / 16;
+			for (size_t i = 0; i < 8; i++) {
+				acc += mix16(input + 16 * i, secret + 16 * i);
+			}
+			acc = avalanche(acc);
+			for (size_t i = 8; i < rounds; i++) {
+				acc += mix16(input + 16 * i, secret + 16 * (i - 8) + 3);
+			}
+			acc += mix16(input + length - 16, secret + 136 - 17);
+			return avalanche(acc);
+		}
+		return hash_long(input, length);
+	}
+}
+
+//CRC-32C (Castagnoli); SSE4.2/ARMv8 CRC instructions when present, slicing-by-8 tables otherwise
+namespace crc32c {
+	static constexpr std::array<std::array<uint32_t, 256>, 8> make_tables() {
+		std::array<std::array<uint32_t, 256>, 8> tables{};
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t crc = i;
+			for (int bit = 0; bit < 8; bit++) {
+				crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1)));
+			}
+			tables[0][i] = crc;
+		}
+		for (uint32_t i = 0; i < 256; i++) {
+			for (size_t slice = 1; slice < 8; slice++) {
+				tables[slice][i] = (tables[slice - 1][i] >> 8) ^ tables[0][tables[slice - 1][i] & 0xFF];
+			}
+		}
+		return tables;
+	}
+
+	static constexpr auto tables = make_tables();
+
+	static uint32_t update_table(uint32_t crc, const uint8_t* input, size_t length) {
+		while (length >= 8) {
+			uint32_t low = read32(input) ^ crc;
+			uint32_t high = read32(input + 4);
+			crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24] ^
+				tables[3][high & 0xFF] ^ tables[2][(high >> 8) & 0xFF] ^ tables[1][(high >> 16) & 0xFF] ^ tables[0][high >> 24];
+			input += 8;
+			length -= 8;
+		}
+		while (length-- > 0) {
+			crc = (crc >> 8) ^ tables[0][(crc ^ *input++) & 0xFF];
+		}
+		return crc;
+	}
+
+#if defined(HULAUTILS_CRC32C_SSE42)
+#if defined(__GNUC__) || defined(__clang__)
+	__attribute__((target("sse4.2")))
+#endif
+	static uint32_t update_hardware(uint32_t crc, const uint8_t* input, size_t length) {
+		uint64_t crc64 = crc;
+		while (length >= 8) {
+			crc64 = _mm_crc32_u64(crc64, read64(input));
+			input += 8;
+			length -= 8;
+		}
+		crc = static_cast<uint32_t>(crc64);
+		while (length-- > 0) {
+			crc = _mm_crc32_u8(crc, *input++);
+		}
+		return crc;
+	}
+
+	static bool detect_hardware() {
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_cpu_supports("sse4.2");
+#else
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] >> 20) & 1;
+#endif
+	}
+#elif defined(HULAUTILS_CRC32C_ARM)
+	static uint32_t update_hardware(uint32_t crc, const uint8_t* input, size_t length) {
+		while (length >= 8) {
+			crc = __crc32cd(crc, read64(input));
+			input += 8;
+			length -= 8;
+		}
+		while (length-- > 0) {
+			crc = __crc32cb(crc, *input++);
+		}
+		return crc;
+	}
+
+	static bool detect_hardware() {
+		return true;
+	}
+#endif
+
+	static uint32_t hash(const uint8_t* input, size_t length) {
+#if defined(HULAUTILS_CRC32C_SSE42) || defined(HULAUTILS_CRC32C_ARM)
+		static const bool has_hardware = detect_hardware();
+		if (has_hardware) {
+			return ~update_hardware(0xFFFFFFFFu, input, length);
+		}
+#endif
+		return ~update_table(0xFFFFFFFFu, input, length);
+	}
+}
+
+//FIPS 180-4 SHA-256
+namespace sha256 {
+	static constexpr uint32_t round_constants[64] = {
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+	};
+
+	static void compress(uint32_t* state, const uint8_t* block) {
+		uint32_t schedule[64];
+		for (size_t i = 0; i < 16; i++) {
+			schedule[i] = (static_cast<uint32_t>(block[4 * i]) << 24) | (static_cast<uint32_t>(block[4 * i + 1]) << 16) | (static_cast<uint32_t>(block[4 * i + 2]) << 8) | block[4 * i + 3];
+		}
+		for (size_t i = 16; i < 64; i++) {
+			uint32_t s0 = std::rotr(schedule[i - 15], 7) ^ std::rotr(schedule[i - 15], 18) ^ (schedule[i - 15] >> 3);
+			uint32_t s1 = std::rotr(schedule[i - 2], 17) ^ std::rotr(schedule[i - 2], 19) ^ (schedule[i - 2] >> 10);
+			schedule[i] = schedule[i - 16] + s0 + schedule[i - 7] + s1;
+		}
+
+		uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+		for (size_t i = 0; i < 64; i++) {
+			uint32_t t1 = h + (std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25)) + ((e & f) ^ (~e & g)) + round_constants[i] + schedule[i];
+			uint32_t t2 = (std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+		state[5] += f;
+		state[6] += g;
+		state[7] += h;
+	}
+
+	static std::array<uint8_t, 32> hash(const uint8_t* input, size_t length) {
+		uint32_t state[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+		size_t full_blocks = length / 64;
+		for (size_t i = 0; i < full_blocks; i++) {
+			compress(state, input + 64 * i);
+		}
+
+		//the padding and bit length spill into a second block when fewer than 9 bytes remain
+		uint8_t tail[128] = { 0 };
+		size_t remaining = length - full_blocks * 64;
+		std::memcpy(tail, input + full_blocks * 64, remaining);
+		tail[remaining] = 0x80;
+		size_t tail_length = remaining + 9 > 64 ? 128 : 64;
+		uint64_t bit_length = static_cast<uint64_t>(length) * 8;
+		for (size_t i = 0; i < 8; i++) {
+			tail[tail_length - 1 - i] = static_cast<uint8_t>(bit_length >> (8 * i));
+		}
+		for (size_t offset = 0; offset < tail_length; offset += 64) {
+			compress(state, tail + offset);
+		}
+
+		std::array<uint8_t, 32> digest;
+		for (size_t i = 0; i < 8; i++) {
+			digest[4 * i] = static_cast<uint8_t>(state[i] >> 24);
+			digest[4 * i + 1] = static_cast<uint8_t>(state[i] >> 16);
+			digest[4 * i + 2] = static_cast<uint8_t>(state[i] >> 8);
+			digest[4 * i + 3] = static_cast<uint8_t>(state[i]);
+		}
+		return digest;
+	}
+}
+
+static std::string to_hex(const uint8_t* bytes, size_t count) {
+	static constexpr char digits[] = "0123456789abcdef";
+	std::string hex(count * 2, '0');
+	for (size_t i = 0; i < count; i++) {
+		hex[2 * i] = digits[bytes[i] >> 4];
+		hex[2 * i + 1] = digits[bytes[i] & 0xF];
+	}
+	return hex;
+}
+
+//integer digests print big-endian, the way xxhsum and crc32c tools show them
+static std::string to_hex(uint64_t value, size_t byte_count) {
+	uint8_t bytes[8];
+	for (size_t i = 0; i < byte_count; i++) {
+		bytes[i] = static_cast<uint8_t>(value >> (8 * (byte_count - 1 - i)));
+	}
+	return to_hex(bytes, byte_count);
+}
+
+std::string HulaUtils::hash_digest(hash_algorithm algorithm, const char* data, size_t size) {
+	const uint8_t* input = reinterpret_cast<const uint8_t*>(data);
+	switch (algorithm)
+	{
+	case hash_algorithm::XXH3:
+		return to_hex(xxh3::hash(input, size), 8);
+	case hash_algorithm::CRC32C:
+		return to_hex(crc32c::hash(input, size), 4);
+	case hash_algorithm::SHA256: {
+		auto digest = sha256::hash(input, size);
+		return to_hex(digest.data(), digest.size());
+	}
+	}
+	return std::string(); //unreachable
+}
+
+hash_algorithm HulaUtils::expect_hash_algorithm(HulaScript::instance::value& value, HulaScript::instance& instance) {
+	std::string name = value.str(instance);
+	switch (HulaScript::Hash::strhash(name))
+	{
+	case HulaScript::Hash::strhash("xxh3"):
+		return hash_algorithm::XXH3;
+	case HulaScript::Hash::strhash("crc32c"):
+		return hash_algorithm::CRC32C;
+	case HulaScript::Hash::strhash("sha256"):
+		return hash_algorithm::SHA256;
+	default: {
+		std::stringstream ss;
+		ss << "Unknown hash algorithm \"" << name << "\". Expected xxh3, crc32c or sha256.";
+		instance.panic(ss.str());
+		return hash_algorithm::XXH3; //unreachable
+	}
+	}
+}
+
+static hash_algorithm optional_algorithm(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance) {
+	if (args.size() == 2) {
+		return expect_hash_algorithm(args[1], instance);
+	}
+	HULASCRIPT_EXPECT_ARGS(1);
+	return hash_algorithm::XXH3;
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::hashString(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	hash_algorithm algorithm = optional_algorithm(args, instance);
+
+	if (args[0].check_type(HulaScript::instance::value::vtype::FOREIGN_OBJECT)) {
+		native_array& array = expect_native_array(args[0], instance);
+		return instance.make_string(hash_digest(algorithm, array.data_bytes(), array.length() * array.element_size()));
+	}
+
+	std::string str = args[0].str(instance);
+	return instance.make_string(hash_digest(algorithm, str.data(), str.size()));
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::hashFile(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	hash_algorithm algorithm = optional_algorithm(args, instance);
+
+	auto contents = file_contents::load(args[0].str(instance));
+	if (!contents.has_value()) {
+		return HulaScript::instance::value();
+	}
+	std::string_view view = contents->view();
+	return instance.make_string(hash_digest(algorithm, view.data(), view.size()));
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::hashFiles(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	hash_algorithm algorithm = optional_algorithm(args, instance);
+
+	HulaScript::ffi_table_helper helper(args[0], instance);
+	if (!helper.is_array()) {
+		instance.panic("Type Error: Expected an array of paths.");
+	}
+	size_t count = helper.get_size();
+	std::vector<std::string> paths;
+	paths.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		paths.push_back(helper.get(instance.rational_integer(i)).str(instance));
+	}
+
+	std::vector<std::optional<std::string>> digests(paths.size());
+	worker_pool().parallel_for(paths.size(), [&](size_t i) {
+		auto contents = file_contents::load(paths[i]);
+		if (contents.has_value()) {
+			std::string_view view = contents->view();
+			digests[i] = hash_digest(algorithm, view.data(), view.size());
+		}
+	});
+
+	std::vector<HulaScript::instance::value> results;
+	results.reserve(digests.size());
+	for (auto& digest : digests) {
+		results.push_back(digest.has_value() ? instance.make_string(digest.value()) : HulaScript::instance::value());
+		instance.temp_gc_protect(results.back());
+	}
+
+	auto result = instance.make_array(results);
+	for (size_t i = 0; i < results.size(); i++) {
+		instance.temp_gc_unprotect();
+	}
+	return result;
+}
@@ -1,129 +1,174 @@
 #include "HulaUtils.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
 #include <sstream>
 #include <cctype>
 
 using namespace HulaUtils;
 
-void write_json(HulaScript::instance::value& current, std::stringstream& ss, HulaScript::instance& instance, int indent = -1, std::optional<std::string> json_property = std::nullopt) {
-	for (int i = 0; i < indent; i++) { ss << '\t'; }
-	if (json_property.has_value()) {
-		ss << '\"' << json_property.value() << "\" : ";
+static constexpr HulaScript::interned_key json_keys_key("@json_keys");
+static constexpr HulaScript::interned_key json_constructor_key("@json_constructor");
+
+//for each byte: 0 if it is copied as is, otherwise the character written after the backslash
+static constexpr std::array<char, 256> make_escape_table() {
+	std::array<char, 256> table{};
+	for (int c = 0; c < 0x20; c++) {
+		table[c] = 'u';
+	}
+	table['\b'] = 'b';
+	table['\t'] = 't';
+	table['\n'] = 'n';
+	table['\f'] = 'f';
+	table['\r'] = 'r';
+	table['\"'] = '\"';
+	table['\\'] = '\\';
+	return table;
+}
+
+static constexpr auto escape_table = make_escape_table();
+
+static void write_json_string(std::string& out, std::string_view str) {
+	static constexpr char hex_digits[] = "0123456789abcdef";
+
+	out.push_back('\"');
+	size_t run_start = 0;
+	for (size_t i = 0; i < str.size(); i++) {
+		char escape = escape_table[static_cast<uint8_t>(str[i])];
+		if (escape == 0) {
+			continue;
+		}
+
+		out.append(str.data() + run_start, i - run_start);
+		out.push_back('\\');
+		out.push_back(escape);
+		if (escape == 'u') {
+			out.append("00");
+			out.push_back(hex_digits[static_cast<uint8_t>(str[i]) >> 4]);
+			out.push_back(hex_digits[static_cast<uint8_t>(str[i]) & 0xF]);
+		}
+		run_start = i + 1;
+	}
+	out.append(str.data() + run_start, str.size() - run_start);
+	out.push_back('\"');
+}
+
+static void write_indent(std::string& out, int indent) {
+	if (indent > 0) {
+		out.append(indent, '\t');
+	}
+}
+
+static void write_json(HulaScript::instance::value& current, std::string& out, HulaScript::instance& instance, int indent = -1, const std::string* json_property = nullptr) {
+	write_indent(out, indent);
+	if (json_property != nullptr) {
+		write_json_string(out, *json_property);
+		out.append(" : ");
 	}
 
 	if (current.check_type(HulaScript::instance::value::vtype::BOOLEAN)) {
-		ss << current.boolean(instance) ? "true" : "false";
+		out.append(current.boolean(instance) ? "true" : "false");
 		return;
 	}
 	else if (current.check_type(HulaScript::instance::value::vtype::NIL)) {
-		ss << "null";
+		out.append("null");
 		return;
 	}
 	else if (current.check_type(HulaScript::instance::value::vtype::DOUBLE)) {
-		ss << current.number(instance);
+		double number = current.number(instance);
+		if (!std::isfinite(number)) {
+			//JSON has no spelling for NaN or infinity
+			out.append("null");
+			return;
+		}
+
+		char buffer[32];
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+		out.append(buffer, result.ptr - buffer);
 		return;
 	}
 	else if (current.check_type(HulaScript::instance::value::vtype::RATIONAL)) {
-		ss << instance.rational_to_string(current, false) << 'r';
+		out.append(instance.rational_to_string(current, false));
+		out.push_back('r');
 		return;
 	}
 	else if (current.check_type(HulaScript::instance::value::vtype::STRING)) {
-		ss << '\"';
-		for (auto c : current.str(instance)) {
-			switch (c)
-			{
-			case '\"':
-				ss << '\\\"';
-				break;
-			case '\'':
-				ss << '\\\'';
-				break;
-			case '\t':
-				ss << '\\t';
-				break;
-			case '\n':
-				ss << '\\n';
-				break;
-			default:
-				ss << c;
-				break;
-			}
-		}
-		ss << '\"';
+		write_json_string(out, current.str(instance));
 		return;
 	}
 	else if (current.check_type(HulaScript::instance::value::vtype::TABLE)) {
 		HulaScript::ffi_table_helper helper(current, instance);
+		int child_indent = indent >= 0 ? indent + 1 : -1;
 
 		if (helper.is_array()) {
-			ss << '[';
-			for (size_t i = 0; i < helper.get_size(); i++) {
+			out.push_back('[');
+			size_t size = helper.get_size();
+			for (size_t i = 0; i < size; i++) {
 				if (i > 0) {
-					ss << ',';
+					out.push_back(',');
 				}
 				if (indent >= 0) {
-					ss << '\n';
-					auto elem = helper.get(instance.rational_integer(i));
-					write_json(elem, ss, instance, indent + 1);
-				}
-				else {
-					auto elem = helper.get(instance.rational_integer(i));
-					write_json(elem, ss, instance, -1);
+					out.push_back('\n');
 				}
+				auto elem = helper.get(instance.rational_integer(i));
+				write_json(elem, out, instance, child_indent);
 			}
 			if (indent >= 0) {
-				ss << '\n';
-				for (int i = 0; i < indent; i++) { ss << '\t'; }
+				out.push_back('\n');
+				write_indent(out, indent);
 			}
-			ss << ']';
+			out.push_back(']');
 			return;
 		}
-		auto key_value = helper.get(std::string("@json_keys"));
+		auto key_value = helper.get(json_keys_key);
 		if(!key_value.check_type(HulaScript::instance::value::vtype::NIL)) {
 			HulaScript::ffi_table_helper key_table_helper(key_value, instance);
 			if (key_table_helper.is_array()) {
+				size_t key_count = key_table_helper.get_size();
 				std::vector<std::string> keys;
+				std::vector<HulaScript::interned_key> interned_keys;
 				std::vector<HulaScript::instance::value> key_strs;
-				keys.reserve(key_table_helper.get_size() + 1);
-				for (size_t i = 0; i < key_table_helper.get_size(); i++) {
+				keys.reserve(key_count + 1);
+				interned_keys.reserve(key_count + 1);
+				for (size_t i = 0; i < key_count; i++) {
 					keys.push_back(key_table_helper.get(instance.rational_integer(i)).str(instance));
+					interned_keys.push_back(HulaScript::interned_key(keys.back()));
 					key_strs.push_back(instance.make_string(keys.back()));
 				}
 
-				if (!helper.get(std::string("@json_constructor")).check_type(HulaScript::instance::value::vtype::NIL)) {
+				if (!helper.get(json_constructor_key).check_type(HulaScript::instance::value::vtype::NIL)) {
 					keys.push_back("@json_constructor");
+					interned_keys.push_back(json_constructor_key);
 				}
 
-				ss << '{';
-				for (std::string& key : keys) {
-					if (key != keys.front()) {
-						ss << ',';
+				out.push_back('{');
+				for (size_t i = 0; i < keys.size(); i++) {
+					if (i > 0) {
+						out.push_back(',');
 					}
 					if (indent >= 0) {
-						ss << '\n';
-						auto elem = helper.get(key);
-						write_json(elem, ss, instance, indent + 1, key);
-					}
-					else {
-						auto elem = helper.get(key);
-						write_json(elem, ss, instance, -1, key);
+						out.push_back('\n');
 					}
+					auto elem = helper.get(interned_keys[i]);
+					write_json(elem, out, instance, child_indent, &keys[i]);
 				}
 				if (keys.size() > 0) {
-					ss << ',';
+					out.push_back(',');
 				}
-				int keys_property_indent = -1;
 				if (indent >= 0) {
-					ss << '\n';
-					keys_property_indent = indent + 1;
+					out.push_back('\n');
 				}
+				static const std::string keys_property = "@json_keys";
 				auto key_array_value = instance.make_array(key_strs);
-				write_json(key_array_value, ss, instance, keys_property_indent, "@json_keys");
+				write_json(key_array_value, out, instance, child_indent, &keys_property);
 
 				if (indent >= 0) {
-					ss << '\n';
-					for (int i = 0; i < indent; i++) { ss << '\t'; }
+					out.push_back('\n');
+					write_indent(out, indent);
 				}
-				ss << '}';
+				out.push_back('}');
 				return;
 			}
 			else {
@@ -131,8 +176,7 @@ void write_json(HulaScript::instance::value& current, std::stringstream& ss, Hul
 			}
 		}
 	}
-	std::string json_source = instance.invoke_method(current, "toJSON", {}).str(instance);
-	ss << json_source;
+	out.append(instance.invoke_method(current, "toJSON", {}).str(instance));
 }
 
 DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::JSONParser(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
@@ -150,38 +194,189 @@ DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::toJSON(std::vec
 		HULASCRIPT_EXPECT_ARGS(1);
 	}
 
-	std::stringstream ss;
-	write_json(args.at(0), ss, instance, allow_newline ? 0 : -1);
+	std::string out;
+	out.reserve(256);
+	write_json(args.at(0), out, instance, allow_newline ? 0 : -1);
 
-	return instance.make_string(ss.str());
+	return instance.make_string(std::move(out));
 }
 
-HulaScript::instance::value HulaUtils::json_parser::add_constructor(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+HulaScript::instance::value HulaUtils::json_parser::add_constructor(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
 {
 	HULASCRIPT_EXPECT_ARGS(3);
 
-	size_t name_hash = HulaScript::Hash::dj2b(args.at(0).str(instance).c_str());
+	size_t name_hash = HulaScript::Hash::strhash(args[0].str(instance));
+
+	HulaScript::ffi_table_helper table_helper(args[2], instance);
+	json_constructor_plan plan;
+	plan.constructor = args[1];
+	plan.argument_count = static_cast<uint32_t>(table_helper.get_size());
+	plan.slots.reserve(plan.argument_count);
+	for (uint32_t i = 0; i < plan.argument_count; i++) {
+		plan.slots.push_back({ HulaScript::Hash::strhash(table_helper.get(instance.rational_integer(i)).str(instance)), i });
+	}
+	std::sort(plan.slots.begin(), plan.slots.end());
+
+	auto it = object_parsers.find(name_hash);
+	if (it != object_parsers.end()) {
+		//a schema registered first leaves the constructor nil, for this call to fill in
+		if (!it->second.constructor.check_type(HulaScript::instance::value::vtype::NIL)) {
+			return HulaScript::instance::value(false);
+		}
+		plan.schema = it->second.schema;
+		it->second = std::move(plan);
+		return HulaScript::instance::value(true);
+	}
+	return HulaScript::instance::value(object_parsers.insert({ name_hash, std::move(plan) }).second);
+}
+
+//fields land in their argument slots directly; undeclared fields are dropped and missing ones stay nil
+static HulaScript::instance::value invoke_constructor_plan(const json_constructor_plan& plan, const std::vector<json_field>& fields, HulaScript::instance& instance) {
+	std::vector<HulaScript::instance::value> arguments(plan.argument_count);
+	for (const json_field& field : fields) {
+		if (!field.string_key) {
+			continue;
+		}
+		auto slot = std::lower_bound(plan.slots.begin(), plan.slots.end(), std::make_pair(field.key_hash, static_cast<uint32_t>(0)));
+		for (; slot != plan.slots.end() && slot->first == field.key_hash; slot++) {
+			arguments[slot->second] = field.value;
+		}
+	}
+	return instance.invoke_value(plan.constructor, std::span<const HulaScript::instance::value>(arguments));
+}
+
+HulaScript::instance::value HulaUtils::build_json_object(std::vector<json_field>& fields, const json_constructor_plans& plans, HulaScript::instance& instance)
+{
+	//the last @json_constructor wins, as it would in a table
+	const json_field* constructor_field = nullptr;
+	for (const json_field& field : fields) {
+		if (field.string_key && field.key_hash == json_constructor_key.hash()) {
+			constructor_field = &field;
+		}
+	}
+
+	if (constructor_field == nullptr) {
+		HulaScript::ffi_table_helper helper(fields.size(), instance);
+		for (json_field& field : fields) {
+			if (field.string_key) {
+				//emplacing a std::string would store only its hash, losing the key's text
+				auto key = instance.make_string(std::move(field.key));
+				instance.temp_gc_protect(key);
+				helper.emplace(key, field.value);
+				instance.temp_gc_unprotect();
+			}
+			else {
+				helper.emplace(field.key_value, field.value);
+			}
+		}
+		return helper.get_table();
+	}
+
+	std::string constructor_name = constructor_field->value.str(instance);
+	auto it = plans.find(HulaScript::Hash::strhash(constructor_name));
+	if (it == plans.end() || it->second.constructor.check_type(HulaScript::instance::value::vtype::NIL)) {
+		std::stringstream ss;
+		ss << "Json Parse Error: Invalid @json_constructor \"" << constructor_name << "\".";
+		instance.panic(ss.str());
+	}
+	return invoke_constructor_plan(it->second, fields, instance);
+}
+
+static constexpr HulaScript::interned_key schema_name_key("name");
+static constexpr HulaScript::interned_key schema_type_key("type");
+static constexpr HulaScript::interned_key schema_items_key("items");
+static constexpr HulaScript::interned_key schema_required_key("required");
+static constexpr HulaScript::interned_key schema_default_key("default");
+
+//a nil type means any; names that aren't built in refer to another schema
+static json_value_type parse_schema_type(HulaScript::instance::value type_value, size_t& schema_hash, HulaScript::instance& instance) {
+	schema_hash = 0;
+	if (type_value.check_type(HulaScript::instance::value::vtype::NIL)) {
+		return json_value_type::ANY;
+	}
+
+	std::string type_name = type_value.str(instance);
+	switch (HulaScript::Hash::strhash(type_name))
+	{
+	case HulaScript::Hash::strhash("any"):
+		return json_value_type::ANY;
+	case HulaScript::Hash::strhash("number"):
+		return json_value_type::NUMBER;
+	case HulaScript::Hash::strhash("string"):
+		return json_value_type::STRING;
+	case HulaScript::Hash::strhash("boolean"):
+		return json_value_type::BOOLEAN;
+	case HulaScript::Hash::strhash("array"):
+		return json_value_type::ARRAY;
+	case HulaScript::Hash::strhash("object"):
+		return json_value_type::OBJECT;
+	case HulaScript::Hash::strhash("Float64Array"):
+		return json_value_type::FLOAT64_ARRAY;
+	case HulaScript::Hash::strhash("Int64Array"):
+		return json_value_type::INT64_ARRAY;
+	default:
+		schema_hash = HulaScript::Hash::strhash(type_name);
+		return json_value_type::SCHEMA;
+	}
+}
+
+HulaScript::instance::value HulaUtils::json_parser::add_schema(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(2);
+
+	size_t name_hash = HulaScript::Hash::strhash(args[0].str(instance));
+
+	HulaScript::ffi_table_helper fields_helper(args[1], instance);
+	if (!fields_helper.is_array()) {
+		instance.panic("Schema Error: Expected an array of field descriptions.");
+	}
+
+	auto schema = std::make_shared<json_schema>();
+	size_t field_count = fields_helper.get_size();
+	schema->fields.reserve(field_count);
+	schema->slots.reserve(field_count);
+	for (size_t i = 0; i < field_count; i++) {
+		HulaScript::ffi_table_helper description(fields_helper.get(instance.rational_integer(i)), instance);
+
+		json_schema_field field;
+		field.name = description.get(schema_name_key).str(instance);
+		field.type = parse_schema_type(description.get(schema_type_key), field.schema_hash, instance);
+
+		auto items_value = description.get(schema_items_key);
+		field.item_type = parse_schema_type(items_value, field.item_schema_hash, instance);
+		if (field.type != json_value_type::ARRAY && field.item_type != json_value_type::ANY) {
+			std::stringstream ss;
+			ss << "Schema Error: Field \"" << field.name << "\" declares items but isn't an array.";
+			instance.panic(ss.str());
+		}
+
+		auto required_value = description.get(schema_required_key);
+		field.required = !required_value.check_type(HulaScript::instance::value::vtype::NIL) && required_value.boolean(instance);
+		field.default_value = description.get(schema_default_key);
 
-	HulaScript::ffi_table_helper table_helper(args.at(2), instance);
-	std::vector<std::string> arguments;
-	arguments.reserve(table_helper.get_size());
-	for (size_t i = 0; i < table_helper.get_size(); i++) {
-		arguments.push_back(table_helper.get(instance.rational_integer(i)).str(instance));
+		schema->slots.push_back({ HulaScript::Hash::strhash(field.name), static_cast<uint32_t>(i) });
+		schema->fields.push_back(std::move(field));
 	}
+	std::sort(schema->slots.begin(), schema->slots.end());
 
-	return HulaScript::instance::value(object_parsers.insert({ name_hash, std::make_pair(args.at(1), arguments) }).second);
+	auto result = object_parsers.try_emplace(name_hash);
+	if (result.second) {
+		result.first->second.argument_count = 0;
+	}
+	result.first->second.schema = schema;
+	return HulaScript::instance::value(true);
 }
 
 class json_scanner {
 private:
 	std::string source;
-	int position;
+	size_t position;
 
 	HulaScript::instance& instance;
-	std::unordered_map<size_t, std::pair<HulaScript::instance::value, std::vector<std::string>>>& object_parsers;
+	const json_constructor_plans& object_parsers;
 
 public:
-	json_scanner(std::string source, std::unordered_map<size_t, std::pair<HulaScript::instance::value, std::vector<std::string>>>& object_parsers, HulaScript::instance& instance) : source(source), position(0), object_parsers(object_parsers), instance(instance) {
+	json_scanner(std::string source, const json_constructor_plans& object_parsers, HulaScript::instance& instance) : source(source), position(0), instance(instance), object_parsers(object_parsers) {
 
 	}
 
@@ -202,8 +397,16 @@ public:
 	void match_char(char expected) const;
 	void consume_whitespace() noexcept;
 
-	char parse_char_literal();
+	std::string parse_string_literal();
+	std::string_view scan_number_literal(bool& rational);
+	HulaScript::instance::value parse_number_literal();
 	HulaScript::instance::value parse_json();
+
+	void schema_error(const std::string& field_name, const char* expected);
+	template<typename element_type>
+	HulaScript::instance::value parse_numeric_array(const std::string& field_name);
+	HulaScript::instance::value parse_typed(json_value_type type, size_t schema_hash, json_value_type item_type, size_t item_schema_hash, const std::string& field_name);
+	HulaScript::instance::value parse_schema_object(size_t schema_hash, const std::string& field_name);
 };
 
 void json_scanner::match_char(char expected) const
@@ -217,35 +420,85 @@ void json_scanner::match_char(char expected) const
 
 void json_scanner::consume_whitespace() noexcept
 {
-	while (std::isblank(peek_char()) && peek_char() != EOF) {
-		scan_char();
+	while (position < source.size() && (source[position] == ' ' || source[position] == '\t' || source[position] == '\n' || source[position] == '\r')) {
+		position++;
+	}
+}
+
+std::string json_scanner::parse_string_literal()
+{
+	//find the closing quote, stepping over escapes, then validate and decode the whole run at once
+	const char* start = source.data() + position;
+	const char* source_end = source.data() + source.size();
+	const char* end = start;
+	for (;;) {
+		end = json_tape::find_quote_or_backslash(end, source_end);
+		if (end == source_end) {
+			instance.panic("Json Parse Error: Unterminated string.");
+		}
+		else if (*end == '\"') {
+			break;
+		}
+		end = std::min(end + 2, source_end);
+	}
+	position = static_cast<size_t>(end + 1 - source.data());
+
+	std::string_view raw(start, end - start);
+	if (!json_tape::validate_string(raw)) {
+		instance.panic("Json Parse Error: Control character or invalid UTF-8 in string.");
+	}
+
+	std::string str;
+	if (!json_tape::decode_escapes(raw, str)) {
+		instance.panic("Json Parse Error: Invalid escape sequence in string.");
 	}
+	return str;
 }
 
-char json_scanner::parse_char_literal()
+std::string_view json_scanner::scan_number_literal(bool& rational)
 {
-	char c = scan_char();
-	if (c == '\\') {
-		c = scan_char();
-		switch (c)
-		{
-		case '\"':
-			return '\"';
-		case '\'':
-			return '\'';
-		case 't':
-			return '\t';
-		case 'n':
-			return '\n';
-		default: {
+	auto skip_digits = [this](const char* message) {
+		if (position == source.size() || !std::isdigit(static_cast<unsigned char>(source[position]))) {
 			std::stringstream ss;
-			ss << "Unexpected char \'" << c << "\' in \\ control sequence.";
+			ss << "Json Parse Error: " << message << " at offset " << position << ".";
 			instance.panic(ss.str());
-			break;
 		}
+		while (position < source.size() && std::isdigit(static_cast<unsigned char>(source[position]))) {
+			position++;
 		}
+	};
+
+	//the literal is validated in place and converted without copying it out
+	size_t start = position;
+	if (source[position] == '-') {
+		position++;
+	}
+	skip_digits("Expected a digit");
+	if (peek_char() == '.') {
+		position++;
+		skip_digits("Expected a digit after the decimal point");
 	}
-	return c;
+	if (peek_char() == 'e' || peek_char() == 'E') {
+		position++;
+		if (peek_char() == '+' || peek_char() == '-') {
+			position++;
+		}
+		skip_digits("Expected a digit in the exponent");
+	}
+	std::string_view literal = std::string_view(source).substr(start, position - start);
+
+	rational = peek_char() == 'r';
+	if (rational) {
+		position++;
+	}
+	return literal;
+}
+
+HulaScript::instance::value json_scanner::parse_number_literal()
+{
+	bool rational;
+	std::string_view literal = scan_number_literal(rational);
+	return json_tape::parse_number(literal, rational, instance);
 }
 
 HulaScript::instance::value json_scanner::parse_json()
@@ -253,30 +506,27 @@ HulaScript::instance::value json_scanner::parse_json()
 	consume_whitespace();
 
 	char peeked = peek_char();
-	if (std::isdigit(peeked)) {
-		std::string num_str;
-		
-		do {
-			num_str.push_back(scan_char());
-		} while (std::isdigit(peek_char()) || peek_char() == '.');
-
-		if (peek_char() == 'r') {
-			scan_char();
-			return instance.parse_rational(num_str);
+	if (std::isdigit(peeked) || peeked == '-') {
+		return parse_number_literal();
+	}
+	else if (peeked == 't' || peeked == 'f' || peeked == 'n') {
+		const char* literal = peeked == 't' ? "true" : (peeked == 'f' ? "false" : "null");
+		size_t length = std::strlen(literal);
+		if (source.compare(position, length, literal) != 0) {
+			std::stringstream ss;
+			ss << "Json Parse Error: Invalid literal at offset " << position << ".";
+			instance.panic(ss.str());
 		}
-		else {
-			return HulaScript::instance::value(std::stod(num_str));
+		position += length;
+
+		if (peeked == 'n') {
+			return HulaScript::instance::value();
 		}
+		return HulaScript::instance::value(peeked == 't');
 	}
 	else if (peeked == '\"') {
 		scan_char();
-
-		std::string str;
-		while (peek_char() != '\"') {
-			str.push_back(parse_char_literal());
-		}
-		scan_char();
-		return instance.make_string(str);
+		return instance.make_string(parse_string_literal());
 	}
 	else if (peeked == '[') {
 		scan_char();
@@ -302,7 +552,8 @@ HulaScript::instance::value json_scanner::parse_json()
 	else if (peeked == '{') {
 		scan_char();
 
-		std::vector<std::pair<HulaScript::instance::value, HulaScript::instance::value>> elements;
+		std::vector<json_field> fields;
+		size_t protected_count = 0;
 		bool first = true;
 		consume_whitespace();
 		while (peek_char() != '}') {
@@ -315,56 +566,282 @@ HulaScript::instance::value json_scanner::parse_json()
 				scan_char();
 			}
 
-			auto key = parse_json();
-			instance.temp_gc_protect(key);
+			json_field field;
+			consume_whitespace();
+			if (peek_char() == '\"') {
+				scan_char();
+				field.string_key = true;
+				field.key = parse_string_literal();
+				field.key_hash = HulaScript::Hash::strhash(field.key);
+			}
+			else {
+				field.string_key = false;
+				field.key_hash = 0;
+				field.key_value = parse_json();
+				instance.temp_gc_protect(field.key_value);
+				protected_count++;
+			}
 			consume_whitespace();
 			match_char(':');
 			scan_char();
-			auto value = parse_json();
+			field.value = parse_json();
 			consume_whitespace();
-			instance.temp_gc_protect(value);
+			instance.temp_gc_protect(field.value);
+			protected_count++;
 
-			elements.push_back(std::make_pair(key, value));
+			fields.push_back(std::move(field));
 		}
 		scan_char();
 
-		HulaScript::ffi_table_helper helper(elements.size(), instance);
-		for (auto& key_value_pair : elements) {
-			helper.emplace(key_value_pair.first, key_value_pair.second);
+		auto result = build_json_object(fields, object_parsers, instance);
+		for (size_t i = 0; i < protected_count; i++) {
 			instance.temp_gc_unprotect();
+		}
+		return result;
+	}
+
+	std::stringstream ss;
+	ss << "Json Parse Error: Unexpected char \'" << peeked << "\'.";
+	instance.panic(ss.str());
+	return HulaScript::instance::value();
+}
+
+void json_scanner::schema_error(const std::string& field_name, const char* expected)
+{
+	std::stringstream ss;
+	ss << "Schema Error: Field \"" << field_name << "\" expected " << expected << " at offset " << position << ".";
+	instance.panic(ss.str());
+}
+
+//numbers go straight into native storage without becoming script values
+template<typename element_type>
+HulaScript::instance::value json_scanner::parse_numeric_array(const std::string& field_name)
+{
+	if (peek_char() != '[') {
+		schema_error(field_name, "an array of numbers");
+	}
+	scan_char();
+
+	std::vector<element_type> elements;
+	consume_whitespace();
+	while (peek_char() != ']') {
+		if (!elements.empty()) {
+			match_char(',');
+			scan_char();
+			consume_whitespace();
+		}
+		if (!std::isdigit(static_cast<unsigned char>(peek_char())) && peek_char() != '-') {
+			schema_error(field_name, "an array of numbers");
+		}
+
+		bool rational;
+		std::string_view literal = scan_number_literal(rational);
+		element_type element{};
+		auto result = std::from_chars(literal.data(), literal.data() + literal.size(), element);
+		if (result.ptr != literal.data() + literal.size() || (result.ec != std::errc() && result.ec != std::errc::result_out_of_range)) {
+			schema_error(field_name, std::is_integral_v<element_type> ? "an array of integers" : "an array of numbers");
+		}
+		else if (result.ec == std::errc::result_out_of_range) {
+			if constexpr (std::is_integral_v<element_type>) {
+				schema_error(field_name, "integers within 64 bits");
+			}
+			else {
+				element = json_tape::parse_number(literal, false, instance).number(instance);
+			}
+		}
+		elements.push_back(element);
+		consume_whitespace();
+	}
+	scan_char();
+	return instance.add_foreign_object(std::make_unique<typed_array<element_type>>(std::move(elements)));
+}
+
+HulaScript::instance::value json_scanner::parse_typed(json_value_type type, size_t schema_hash, json_value_type item_type, size_t item_schema_hash, const std::string& field_name)
+{
+	consume_whitespace();
+	switch (type)
+	{
+	case json_value_type::ANY:
+		return parse_json();
+	case json_value_type::SCHEMA:
+		return parse_schema_object(schema_hash, field_name);
+	case json_value_type::FLOAT64_ARRAY:
+		return parse_numeric_array<double>(field_name);
+	case json_value_type::INT64_ARRAY:
+		return parse_numeric_array<int64_t>(field_name);
+	case json_value_type::ARRAY: {
+		if (item_type == json_value_type::ANY) {
+			break;
+		}
+		if (peek_char() != '[') {
+			schema_error(field_name, "an array");
+		}
+		scan_char();
+
+		std::vector<HulaScript::instance::value> elements;
+		consume_whitespace();
+		while (peek_char() != ']') {
+			if (!elements.empty()) {
+				match_char(',');
+				scan_char();
+			}
+			elements.push_back(parse_typed(item_type, item_schema_hash, json_value_type::ANY, 0, field_name));
+			instance.temp_gc_protect(elements.back());
+			consume_whitespace();
+		}
+		scan_char();
+
+		auto result = instance.make_array(elements);
+		for (size_t i = 0; i < elements.size(); i++) {
 			instance.temp_gc_unprotect();
 		}
+		return result;
+	}
+	default:
+		break;
+	}
 
-		if (!helper.get(std::string("@json_constructor")).check_type(HulaScript::instance::value::vtype::NIL)) {
-			std::string constructor_name = helper.get(std::string("@json_constructor")).str(instance);
-			
-			auto it = object_parsers.find(HulaScript::Hash::dj2b(constructor_name.c_str()));
-			if (it == object_parsers.end()) {
-				std::stringstream ss;
-				ss << "Json Parse Error: Invalid @json_constructor \"" << constructor_name << "\".";
-				instance.panic(ss.str());
+	auto result = parse_json();
+	switch (type)
+	{
+	case json_value_type::NUMBER:
+		if (!result.check_type(HulaScript::instance::value::vtype::DOUBLE) && !result.check_type(HulaScript::instance::value::vtype::RATIONAL)) {
+			schema_error(field_name, "a number");
+		}
+		break;
+	case json_value_type::STRING:
+		if (!result.check_type(HulaScript::instance::value::vtype::STRING)) {
+			schema_error(field_name, "a string");
+		}
+		break;
+	case json_value_type::BOOLEAN:
+		if (!result.check_type(HulaScript::instance::value::vtype::BOOLEAN)) {
+			schema_error(field_name, "a boolean");
+		}
+		break;
+	case json_value_type::ARRAY:
+		if (!result.check_type(HulaScript::instance::value::vtype::TABLE) || !HulaScript::ffi_table_helper(result, instance).is_array()) {
+			schema_error(field_name, "an array");
+		}
+		break;
+	case json_value_type::OBJECT:
+		//constructed objects may be foreign; plain tables count only if they didn't come from a JSON array
+		if (result.check_type(HulaScript::instance::value::vtype::TABLE) ? HulaScript::ffi_table_helper(result, instance).is_array() : !result.check_type(HulaScript::instance::value::vtype::FOREIGN_OBJECT)) {
+			schema_error(field_name, "an object");
+		}
+		break;
+	default:
+		break;
+	}
+	return result;
+}
+
+HulaScript::instance::value json_scanner::parse_schema_object(size_t schema_hash, const std::string& field_name)
+{
+	auto it = object_parsers.find(schema_hash);
+	if (it == object_parsers.end() || it->second.schema == nullptr) {
+		std::stringstream ss;
+		ss << "Schema Error: Field \"" << field_name << "\" refers to a schema that was never added.";
+		instance.panic(ss.str());
+	}
+	const json_constructor_plan& plan = it->second;
+	const json_schema& schema = *plan.schema;
+
+	consume_whitespace();
+	if (peek_char() != '{') {
+		schema_error(field_name, "an object");
+	}
+	scan_char();
+
+	//declared fields are type checked as they're scanned; undeclared ones pass through untouched
+	std::vector<HulaScript::instance::value> values(schema.fields.size());
+	std::vector<bool> present(schema.fields.size(), false);
+	std::vector<json_field> fields;
+	size_t protected_count = 0;
+	bool first = true;
+	consume_whitespace();
+	while (peek_char() != '}') {
+		if (first) {
+			first = false;
+		}
+		else {
+			consume_whitespace();
+			match_char(',');
+			scan_char();
+		}
+
+		json_field field;
+		consume_whitespace();
+		match_char('\"');
+		scan_char();
+		field.string_key = true;
+		field.key = parse_string_literal();
+		field.key_hash = HulaScript::Hash::strhash(field.key);
+		consume_whitespace();
+		match_char(':');
+		scan_char();
+		consume_whitespace();
+
+		auto slot = std::lower_bound(schema.slots.begin(), schema.slots.end(), std::make_pair(field.key_hash, static_cast<uint32_t>(0)));
+		if (slot != schema.slots.end() && slot->first == field.key_hash) {
+			const json_schema_field& declared = schema.fields[slot->second];
+			if (peek_char() == 'n') {
+				//null reads as missing, so defaults and required checks apply
+				parse_json();
+				present[slot->second] = false;
 			}
+			else {
+				values[slot->second] = parse_typed(declared.type, declared.schema_hash, declared.item_type, declared.item_schema_hash, declared.name);
+				instance.temp_gc_protect(values[slot->second]);
+				protected_count++;
+				present[slot->second] = true;
+			}
+		}
+		else {
+			field.value = parse_json();
+			instance.temp_gc_protect(field.value);
+			protected_count++;
+			fields.push_back(std::move(field));
+		}
+		consume_whitespace();
+	}
+	scan_char();
 
-			std::vector<HulaScript::instance::value> arguments;
-			arguments.reserve(it->second.second.size());
-			for (std::string& key : it->second.second) {
-				arguments.push_back(helper.get(key));
+	for (size_t i = 0; i < schema.fields.size(); i++) {
+		const json_schema_field& declared = schema.fields[i];
+		if (!present[i]) {
+			if (declared.required) {
+				std::stringstream ss;
+				ss << "Schema Error: Missing required field \"" << declared.name << "\" before offset " << position << ".";
+				instance.panic(ss.str());
 			}
-			return instance.invoke_value(it->second.first, arguments);
+			values[i] = declared.default_value;
+		}
+		if (!values[i].check_type(HulaScript::instance::value::vtype::NIL)) {
+			fields.push_back({ true, HulaScript::Hash::strhash(declared.name), declared.name, HulaScript::instance::value(), values[i] });
 		}
-		return helper.get_table();
 	}
 
-	std::stringstream ss;
-	ss << "Json Parse Error: Unexpected char \'" << peeked << "\'.";
-	instance.panic(ss.str());
-	return HulaScript::instance::value();
+	auto result = plan.constructor.check_type(HulaScript::instance::value::vtype::NIL) ? build_json_object(fields, object_parsers, instance) : invoke_constructor_plan(plan, fields, instance);
+	for (size_t i = 0; i < protected_count; i++) {
+		instance.temp_gc_unprotect();
+	}
+	return result;
+}
+
+HulaScript::instance::value HulaUtils::json_parser::parse_with_schema(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(2);
+
+	std::string schema_name = args[1].str(instance);
+	json_scanner scanner(args[0].str(instance), object_parsers, instance);
+	return scanner.parse_schema_object(HulaScript::Hash::strhash(schema_name), schema_name);
 }
 
-HulaScript::instance::value HulaUtils::json_parser::parse_json(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+HulaScript::instance::value HulaUtils::json_parser::parse_json(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
 {
 	HULASCRIPT_EXPECT_ARGS(1);
 
-	json_scanner scanner(args.at(0).str(instance), object_parsers, instance);
+	json_scanner scanner(args[0].str(instance), object_parsers, instance);
 	return scanner.parse_json();
 }
\ No newline at end of file
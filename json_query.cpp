@@ -0,0 +1,410 @@
+#include "HulaUtils.hpp"
+#include <array>
+#include <cstring>
+#include <sstream>
+
+using namespace HulaUtils;
+
+//A compiled JSONPath: $ followed by .name, ['name'], [n], .* or [*] steps.
+struct json_path_step {
+	enum step_kind {
+		FIELD,
+		INDEX,
+		WILDCARD
+	} kind;
+
+	std::string name;
+	size_t index;
+};
+
+static std::vector<json_path_step> compile_json_path(const std::string& path, HulaScript::instance& instance) {
+	auto fail = [&](const char* message, size_t offset) {
+		std::stringstream ss;
+		ss << "JSONPath Error: " << message << " at offset " << offset << " in \"" << path << "\".";
+		instance.panic(ss.str());
+	};
+
+	if (path.empty() || path[0] != '$') {
+		fail("Expected the path to start with $", 0);
+	}
+
+	std::vector<json_path_step> steps;
+	size_t i = 1;
+	while (i < path.size()) {
+		if (path[i] == '.') {
+			i++;
+			if (i < path.size() && path[i] == '.') {
+				fail("Recursive descent (..) isn't supported", i);
+			}
+			else if (i < path.size() && path[i] == '*') {
+				steps.push_back({ json_path_step::WILDCARD, "", 0 });
+				i++;
+				continue;
+			}
+
+			size_t start = i;
+			while (i < path.size() && path[i] != '.' && path[i] != '[') {
+				i++;
+			}
+			if (i == start) {
+				fail("Expected a field name", i);
+			}
+			steps.push_back({ json_path_step::FIELD, path.substr(start, i - start), 0 });
+		}
+		else if (path[i] == '[') {
+			i++;
+			if (i < path.size() && path[i] == '*') {
+				steps.push_back({ json_path_step::WILDCARD, "", 0 });
+				i++;
+			}
+			else if (i < path.size() && (path[i] == '\'' || path[i] == '\"')) {
+				char quote = path[i];
+				size_t start = ++i;
+				while (i < path.size() && path[i] != quote) {
+					i++;
+				}
+				if (i == path.size()) {
+					fail("Unterminated quoted field name", start);
+				}
+				steps.push_back({ json_path_step::FIELD, path.substr(start, i - start), 0 });
+				i++;
+			}
+			else {
+				size_t start = i;
+				size_t index = 0;
+				while (i < path.size() && path[i] >= '0' && path[i] <= '9') {
+					index = index * 10 + (path[i] - '0');
+					i++;
+				}
+				if (i == start) {
+					fail("Expected an index, a quoted name or *", i);
+				}
+				steps.push_back({ json_path_step::INDEX, "", index });
+			}
+
+			if (i >= path.size() || path[i] != ']') {
+				fail("Expected ']'", i);
+			}
+			i++;
+		}
+		else {
+			fail("Expected '.' or '['", i);
+		}
+	}
+	return steps;
+}
+
+//character classes for the subtree skipper; everything else is skipped in bulk
+static constexpr std::array<uint8_t, 256> make_structural_table() {
+	std::array<uint8_t, 256> table{};
+	table['\"'] = 1;
+	table['{'] = 1;
+	table['['] = 1;
+	table['}'] = 1;
+	table[']'] = 1;
+	return table;
+}
+
+static constexpr auto structural = make_structural_table();
+
+class json_query_scanner {
+private:
+	const char* begin;
+	const char* p;
+	const char* end;
+	HulaScript::instance& instance;
+
+	const std::vector<std::vector<json_path_step>>& paths;
+	std::vector<std::vector<std::pair<uint32_t, uint32_t>>>& matches;
+
+	using state = std::pair<uint32_t, uint32_t>; //path and step
+
+	void fail(const char* message) {
+		std::stringstream ss;
+		ss << "Json Parse Error: " << message << " at offset " << (p - begin) << ".";
+		instance.panic(ss.str());
+	}
+
+	void skip_space() noexcept {
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+			p++;
+		}
+	}
+
+	void expect(char c) {
+		skip_space();
+		if (p == end || *p != c) {
+			std::string message = std::string("Expected '") + c + "'";
+			fail(message.c_str());
+		}
+		p++;
+	}
+
+	//p is on the opening quote; returns the raw contents and leaves p after the closing quote
+	std::string_view skip_string() {
+		const char* start = ++p;
+		for (;;) {
+			const char* quote = static_cast<const char*>(std::memchr(p, '\"', end - p));
+			if (quote == nullptr) {
+				fail("Unterminated string");
+				return std::string_view(); //unreachable
+			}
+
+			//an odd run of backslashes escapes the quote
+			size_t backslashes = 0;
+			for (const char* back = quote - 1; back >= start && *back == '\\'; back--) {
+				backslashes++;
+			}
+			p = quote + 1;
+			if (backslashes % 2 == 0) {
+				return std::string_view(start, quote - start);
+			}
+		}
+	}
+
+	//skips a value without validating or indexing it
+	void skip_value() {
+		skip_space();
+		if (p == end) {
+			fail("Unexpected end of input");
+			return; //unreachable
+		}
+
+		if (*p == '\"') {
+			skip_string();
+			return;
+		}
+		else if (*p != '{' && *p != '[') {
+			while (p < end && *p != ',' && *p != '}' && *p != ']' && !structural[static_cast<uint8_t>(*p)] && *p != ' ' && *p != '\n' && *p != '\t' && *p != '\r') {
+				p++;
+			}
+			return;
+		}
+
+		size_t depth = 0;
+		while (p < end) {
+			while (p < end && !structural[static_cast<uint8_t>(*p)]) {
+				p++;
+			}
+			if (p == end) {
+				break;
+			}
+
+			switch (*p)
+			{
+			case '\"':
+				skip_string();
+				continue;
+			case '{':
+			case '[':
+				depth++;
+				break;
+			default:
+				depth--;
+				break;
+			}
+			p++;
+			if (depth == 0) {
+				return;
+			}
+		}
+		fail("Unterminated object or array");
+	}
+
+	bool key_matches(const json_path_step& step, std::string_view raw_key) {
+		if (step.kind == json_path_step::WILDCARD) {
+			return true;
+		}
+		else if (step.kind != json_path_step::FIELD) {
+			return false;
+		}
+
+		if (std::memchr(raw_key.data(), '\\', raw_key.size()) == nullptr) {
+			return raw_key == step.name;
+		}
+		std::string decoded;
+		if (!json_tape::decode_escapes(raw_key, decoded)) {
+			fail("Invalid escape sequence");
+		}
+		return decoded == step.name;
+	}
+
+	bool index_matches(const json_path_step& step, size_t index) {
+		return step.kind == json_path_step::WILDCARD || (step.kind == json_path_step::INDEX && step.index == index);
+	}
+
+public:
+	json_query_scanner(std::string_view source, const std::vector<std::vector<json_path_step>>& paths, std::vector<std::vector<std::pair<uint32_t, uint32_t>>>& matches, HulaScript::instance& instance)
+		: begin(source.data()), p(source.data()), end(source.data() + source.size()), instance(instance), paths(paths), matches(matches) { }
+
+	void walk(const std::vector<state>& active) {
+		skip_space();
+		const char* start = p;
+
+		bool matched = false;
+		bool descends = false;
+		for (const state& current : active) {
+			if (current.second == paths[current.first].size()) {
+				matched = true;
+			}
+			else {
+				descends = true;
+			}
+		}
+
+		if (!descends || p == end || (*p != '{' && *p != '[')) {
+			skip_value();
+		}
+		else if (*p == '{') {
+			p++;
+			skip_space();
+			if (p < end && *p == '}') {
+				p++;
+			}
+			else {
+				std::vector<state> next;
+				for (;;) {
+					skip_space();
+					if (p == end || *p != '\"') {
+						fail("Expected a string key");
+						return; //unreachable
+					}
+					std::string_view key = skip_string();
+					expect(':');
+
+					next.clear();
+					for (const state& current : active) {
+						if (current.second < paths[current.first].size() && key_matches(paths[current.first][current.second], key)) {
+							next.push_back({ current.first, current.second + 1 });
+						}
+					}
+					if (next.empty()) {
+						skip_value();
+					}
+					else {
+						walk(next);
+					}
+
+					skip_space();
+					if (p < end && *p == ',') {
+						p++;
+						continue;
+					}
+					expect('}');
+					break;
+				}
+			}
+		}
+		else {
+			p++;
+			skip_space();
+			if (p < end && *p == ']') {
+				p++;
+			}
+			else {
+				std::vector<state> next;
+				for (size_t index = 0;; index++) {
+					next.clear();
+					for (const state& current : active) {
+						if (current.second < paths[current.first].size() && index_matches(paths[current.first][current.second], index)) {
+							next.push_back({ current.first, current.second + 1 });
+						}
+					}
+					if (next.empty()) {
+						skip_value();
+					}
+					else {
+						walk(next);
+					}
+
+					skip_space();
+					if (p < end && *p == ',') {
+						p++;
+						continue;
+					}
+					expect(']');
+					break;
+				}
+			}
+		}
+
+		if (matched) {
+			for (const state& current : active) {
+				if (current.second == paths[current.first].size()) {
+					matches[current.first].push_back({ static_cast<uint32_t>(start - begin), static_cast<uint32_t>(p - start) });
+				}
+			}
+		}
+	}
+
+	void finish() {
+		skip_space();
+		if (p != end) {
+			fail("Unexpected trailing characters");
+		}
+	}
+};
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::queryJSON(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(2);
+
+	std::string source = args[0].str(instance);
+	if (source.size() >= UINT32_MAX) {
+		instance.panic("Json Parse Error: Documents of 4 GiB or more aren't supported.");
+	}
+
+	bool single_path = !args[1].check_type(HulaScript::instance::value::vtype::TABLE);
+	std::vector<std::vector<json_path_step>> paths;
+	if (single_path) {
+		paths.push_back(compile_json_path(args[1].str(instance), instance));
+	}
+	else {
+		HulaScript::ffi_table_helper helper(args[1], instance);
+		size_t count = helper.get_size();
+		paths.reserve(count);
+		for (size_t i = 0; i < count; i++) {
+			paths.push_back(compile_json_path(helper.get(instance.rational_integer(i)).str(instance), instance));
+		}
+	}
+
+	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> matches(paths.size());
+	std::vector<std::pair<uint32_t, uint32_t>> roots;
+	roots.reserve(paths.size());
+	for (uint32_t i = 0; i < paths.size(); i++) {
+		roots.push_back({ i, 0 });
+	}
+
+	json_query_scanner scanner(source, paths, matches, instance);
+	scanner.walk(roots);
+	scanner.finish();
+
+	//only the matched spans are tokenized and turned into script values
+	std::vector<HulaScript::instance::value> results;
+	results.reserve(matches.size());
+	for (auto& path_matches : matches) {
+		std::vector<HulaScript::instance::value> values;
+		values.reserve(path_matches.size());
+		for (auto& span : path_matches) {
+			json_tape tape(source.substr(span.first, span.second));
+			auto error = tape.tokenize();
+			if (error.has_value()) {
+				instance.panic(error.value());
+			}
+			values.push_back(tape.materialize(0, instance));
+			instance.temp_gc_protect(values.back());
+		}
+
+		results.push_back(instance.make_array(values));
+		for (size_t i = 0; i < values.size(); i++) {
+			instance.temp_gc_unprotect();
+		}
+		instance.temp_gc_protect(results.back());
+	}
+
+	auto result = single_path ? results.front() : instance.make_array(results);
+	for (size_t i = 0; i < results.size(); i++) {
+		instance.temp_gc_unprotect();
+	}
+	return result;
+}
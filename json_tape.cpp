@@ -0,0 +1,942 @@
+#include "HulaUtils.hpp"
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HULAUTILS_JSON_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace HulaUtils;
+
+static bool is_json_space(char c) noexcept {
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool is_digit(char c) noexcept {
+	return c >= '0' && c <= '9';
+}
+
+static bool is_escape_char(char c) noexcept {
+	switch (c)
+	{
+	case '\"':
+	case '\'':
+	case '\\':
+	case '/':
+	case 'b':
+	case 'f':
+	case 'n':
+	case 'r':
+	case 't':
+	case 'u':
+		return true;
+	default:
+		return false;
+	}
+}
+
+//the code unit of a \uXXXX escape, or -1 if the four digits aren't hex
+static int32_t parse_hex4(const char* digits) noexcept {
+	int32_t code_unit = 0;
+	for (int i = 0; i < 4; i++) {
+		char c = digits[i];
+		code_unit <<= 4;
+		if (c >= '0' && c <= '9') {
+			code_unit |= c - '0';
+		}
+		else if (c >= 'a' && c <= 'f') {
+			code_unit |= c - 'a' + 10;
+		}
+		else if (c >= 'A' && c <= 'F') {
+			code_unit |= c - 'A' + 10;
+		}
+		else {
+			return -1;
+		}
+	}
+	return code_unit;
+}
+
+static void append_utf8(uint32_t code_point, std::string& out) {
+	if (code_point < 0x80) {
+		out.push_back(static_cast<char>(code_point));
+	}
+	else if (code_point < 0x800) {
+		out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+		out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+	}
+	else if (code_point < 0x10000) {
+		out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+		out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+		out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+	}
+	else {
+		out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+		out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+		out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+		out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+	}
+}
+
+const char* HulaUtils::json_tape::find_quote_or_backslash(const char* p, const char* end) noexcept {
+#ifdef HULAUTILS_JSON_SSE2
+	const __m128i quote = _mm_set1_epi8('\"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	while (end - p >= 16) {
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)));
+		if (mask != 0) {
+			for (; !(mask & 1); mask >>= 1) {
+				p++;
+			}
+			return p;
+		}
+		p += 16;
+	}
+#endif
+	while (p < end && *p != '\"' && *p != '\\') {
+		p++;
+	}
+	return p;
+}
+
+bool HulaUtils::json_tape::validate_string(std::string_view text) noexcept {
+	const uint8_t* p = reinterpret_cast<const uint8_t*>(text.data());
+	const uint8_t* end = p + text.size();
+
+	while (p < end) {
+#ifdef HULAUTILS_JSON_SSE2
+		//printable ASCII runs, the common case, need one signed compare: bytes of 0x80 and up read as negative
+		const __m128i printable = _mm_set1_epi8(0x20);
+		while (end - p >= 16 && _mm_movemask_epi8(_mm_cmplt_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), printable)) == 0) {
+			p += 16;
+		}
+		const uint8_t* stop = end - p > 16 ? p + 16 : end;
+#else
+		const uint8_t* stop = end;
+#endif
+		while (p < stop) {
+			uint8_t lead = *p;
+			if (lead < 0x20) {
+				//JSON strings can't hold raw control characters, newlines included
+				return false;
+			}
+			else if (lead < 0x80) {
+				p++;
+				continue;
+			}
+
+			size_t length;
+			uint32_t code_point;
+			if (lead >= 0xC2 && lead <= 0xDF) {
+				length = 2;
+				code_point = lead & 0x1F;
+			}
+			else if (lead >= 0xE0 && lead <= 0xEF) {
+				length = 3;
+				code_point = lead & 0x0F;
+			}
+			else if (lead >= 0xF0 && lead <= 0xF4) {
+				length = 4;
+				code_point = lead & 0x07;
+			}
+			else {
+				return false;
+			}
+
+			if (static_cast<size_t>(end - p) < length) {
+				return false;
+			}
+			for (size_t i = 1; i < length; i++) {
+				if ((p[i] & 0xC0) != 0x80) {
+					return false;
+				}
+				code_point = (code_point << 6) | (p[i] & 0x3F);
+			}
+
+			//overlong three and four byte forms, UTF-16 surrogates and anything past U+10FFFF
+			if ((length == 3 && code_point < 0x800) || (length == 4 && (code_point < 0x10000 || code_point > 0x10FFFF)) || (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+				return false;
+			}
+			p += length;
+		}
+	}
+	return true;
+}
+
+bool HulaUtils::json_tape::decode_escapes(std::string_view raw, std::string& out) {
+	out.reserve(out.size() + raw.size());
+	while (!raw.empty()) {
+		const char* escape = static_cast<const char*>(std::memchr(raw.data(), '\\', raw.size()));
+		if (escape == nullptr) {
+			out.append(raw);
+			return true;
+		}
+
+		size_t run = escape - raw.data();
+		out.append(raw.data(), run);
+		if (run + 1 >= raw.size()) {
+			return false;
+		}
+
+		switch (raw[run + 1])
+		{
+		case '\"':
+			out.push_back('\"');
+			break;
+		case '\'':
+			out.push_back('\'');
+			break;
+		case '\\':
+			out.push_back('\\');
+			break;
+		case '/':
+			out.push_back('/');
+			break;
+		case 'b':
+			out.push_back('\b');
+			break;
+		case 'f':
+			out.push_back('\f');
+			break;
+		case 'n':
+			out.push_back('\n');
+			break;
+		case 'r':
+			out.push_back('\r');
+			break;
+		case 't':
+			out.push_back('\t');
+			break;
+		case 'u': {
+			if (run + 6 > raw.size()) {
+				return false;
+			}
+			int32_t code_unit = parse_hex4(raw.data() + run + 2);
+			if (code_unit < 0) {
+				return false;
+			}
+			raw.remove_prefix(run + 6);
+
+			uint32_t code_point = code_unit;
+			if (code_unit >= 0xD800 && code_unit <= 0xDBFF) {
+				//a high surrogate only pairs with an immediately following low one
+				int32_t low = raw.size() >= 6 && raw[0] == '\\' && raw[1] == 'u' ? parse_hex4(raw.data() + 2) : -1;
+				if (low >= 0xDC00 && low <= 0xDFFF) {
+					code_point = 0x10000 + ((code_unit - 0xD800) << 10) + (low - 0xDC00);
+					raw.remove_prefix(6);
+				}
+				else {
+					code_point = 0xFFFD;
+				}
+			}
+			else if (code_unit >= 0xDC00 && code_unit <= 0xDFFF) {
+				code_point = 0xFFFD;
+			}
+			append_utf8(code_point, out);
+			continue;
+		}
+		default:
+			return false;
+		}
+		raw.remove_prefix(run + 2);
+	}
+	return true;
+}
+
+HulaScript::instance::value HulaUtils::json_tape::parse_number(std::string_view literal, bool rational, HulaScript::instance& instance) {
+	const char* first = literal.data();
+	const char* last = literal.data() + literal.size();
+
+	//whole numbers skip the text round trip through parse_rational, and convert to double exactly; -0 takes the double path to keep its sign
+	int64_t integer;
+	auto integer_result = std::from_chars(first, last, integer);
+	bool negative_zero = !rational && literal.size() >= 2 && literal[0] == '-' && literal[1] == '0';
+	if (integer_result.ec == std::errc() && integer_result.ptr == last && !negative_zero) {
+		return rational ? instance.rational_integer(integer) : HulaScript::instance::value(static_cast<double>(integer));
+	}
+	else if (rational) {
+		return instance.parse_rational(std::string(literal));
+	}
+
+	//from_chars is locale independent, unlike stod
+	double number;
+	auto result = std::from_chars(first, last, number);
+	if (result.ec == std::errc::result_out_of_range) {
+		//the decimal exponent of the leading significant digit decides between overflow and underflow; the exponent's sign alone doesn't, ie. 1000e-1
+		int64_t magnitude = 0;
+		bool significant = false;
+		bool fraction = false;
+		const char* p = *first == '-' ? first + 1 : first;
+		for (; p < last && *p != 'e' && *p != 'E'; p++) {
+			if (*p == '.') {
+				fraction = true;
+			}
+			else if (significant) {
+				magnitude += fraction ? 0 : 1;
+			}
+			else if (fraction) {
+				magnitude--;
+				significant = *p != '0';
+			}
+			else {
+				significant = *p != '0';
+			}
+		}
+
+		if (p < last) {
+			p++;
+			bool negative_exponent = *p == '-';
+			if (*p == '-' || *p == '+') {
+				p++;
+			}
+			int64_t exponent = 0;
+			for (; p < last && exponent < 100000; p++) {
+				exponent = exponent * 10 + (*p - '0');
+			}
+			magnitude += negative_exponent ? -exponent : exponent;
+		}
+		number = std::copysign(magnitude >= 0 ? HUGE_VAL : 0.0, *first == '-' ? -1.0 : 1.0);
+	}
+	return HulaScript::instance::value(number);
+}
+
+std::optional<std::string> HulaUtils::json_tape::tokenize(bool value_sequence) {
+	if (source.size() >= UINT32_MAX) {
+		return "Json Parse Error: Documents of 4 GiB or more aren't supported.";
+	}
+
+	entries.clear();
+	entries.reserve(source.size() / 8 + 1);
+
+	const char* begin = source.data();
+	const char* end = begin + source.size();
+	const char* p = begin;
+
+	auto error = [&](const char* message) -> std::string {
+		std::stringstream ss;
+		ss << "Json Parse Error: " << message << " at offset " << (p - begin) + source_offset << ".";
+		return ss.str();
+	};
+
+	//p sits on the opening quote; leaves p just past the closing one
+	auto scan_string = [&](entry& scanned) -> bool {
+		p++;
+		scanned.start = static_cast<uint32_t>(p - begin);
+		scanned.flagged = false;
+		for (;;) {
+			p = find_quote_or_backslash(p, end);
+			if (p == end) {
+				return false;
+			}
+			else if (*p == '\"') {
+				break;
+			}
+
+			if (p + 1 == end || !is_escape_char(p[1])) {
+				return false;
+			}
+			else if (p[1] == 'u' && (end - p < 6 || parse_hex4(p + 2) < 0)) {
+				return false;
+			}
+			scanned.flagged = true;
+			p += p[1] == 'u' ? 6 : 2;
+		}
+		scanned.length = static_cast<uint32_t>(p - begin) - scanned.start;
+		p++;
+		return validate_string(std::string_view(begin + scanned.start, scanned.length));
+	};
+
+	enum class expect {
+		VALUE,
+		KEY,
+		AFTER_VALUE
+	} state = expect::VALUE;
+	std::vector<uint32_t> open;
+
+	//a value sequence is JSON Lines: one value per line, so a split after any newline never lands inside a value
+	bool newline = false;
+	auto skip_space = [&]() -> bool {
+		newline = false;
+		while (p < end && is_json_space(*p)) {
+			newline = newline || *p == '\n';
+			p++;
+		}
+		return !(value_sequence && newline && !open.empty());
+	};
+
+	for (;;) {
+		if (!skip_space()) {
+			return error("Expected each value to be on a single line");
+		}
+
+		switch (state)
+		{
+		case expect::VALUE: {
+			if (p == end) {
+				if (value_sequence && open.empty()) {
+					return std::nullopt;
+				}
+				return error("Unexpected end of input");
+			}
+
+			entry scanned = { 0, static_cast<uint32_t>(p - begin), 0, kind::NIL, false };
+			switch (*p)
+			{
+			case '{':
+			case '[': {
+				scanned.type = *p == '{' ? kind::OBJECT : kind::ARRAY;
+				char closing = *p == '{' ? '}' : ']';
+				entries.push_back(scanned);
+				open.push_back(static_cast<uint32_t>(entries.size() - 1));
+				p++;
+
+				//the container is open here, so a newline right after the opener counts as splitting the value
+				if (!skip_space()) {
+					return error("Expected each value to be on a single line");
+				}
+				if (p < end && *p == closing) {
+					open.pop_back();
+					entries.back().payload = entries.size();
+					p++;
+					state = expect::AFTER_VALUE;
+				}
+				else {
+					state = scanned.type == kind::OBJECT ? expect::KEY : expect::VALUE;
+				}
+				continue;
+			}
+			case '\"':
+				scanned.type = kind::STRING;
+				if (!scan_string(scanned)) {
+					return error("Unterminated string, invalid escape sequence, control character or invalid UTF-8");
+				}
+				break;
+			case 't':
+			case 'f':
+			case 'n': {
+				const char* literal = *p == 't' ? "true" : (*p == 'f' ? "false" : "null");
+				size_t length = std::strlen(literal);
+				if (static_cast<size_t>(end - p) < length || std::memcmp(p, literal, length) != 0) {
+					return error("Invalid literal");
+				}
+				scanned.type = *p == 't' ? kind::TRUE : (*p == 'f' ? kind::FALSE : kind::NIL);
+				p += length;
+				break;
+			}
+			default: {
+				if (*p != '-' && !is_digit(*p)) {
+					return error("Unexpected char");
+				}
+
+				scanned.type = kind::NUMBER;
+				if (*p == '-') {
+					p++;
+				}
+				if (p == end || !is_digit(*p)) {
+					return error("Expected a digit");
+				}
+				while (p < end && is_digit(*p)) {
+					p++;
+				}
+				if (p < end && *p == '.') {
+					p++;
+					if (p == end || !is_digit(*p)) {
+						return error("Expected a digit after the decimal point");
+					}
+					while (p < end && is_digit(*p)) {
+						p++;
+					}
+				}
+				if (p < end && (*p == 'e' || *p == 'E')) {
+					p++;
+					if (p < end && (*p == '+' || *p == '-')) {
+						p++;
+					}
+					if (p == end || !is_digit(*p)) {
+						return error("Expected a digit in the exponent");
+					}
+					while (p < end && is_digit(*p)) {
+						p++;
+					}
+				}
+				scanned.length = static_cast<uint32_t>(p - begin) - scanned.start;
+
+				if (p < end && *p == 'r') {
+					scanned.flagged = true;
+					p++;
+				}
+				break;
+			}
+			}
+
+			entries.push_back(scanned);
+			state = expect::AFTER_VALUE;
+			break;
+		}
+		case expect::KEY: {
+			if (p == end || *p != '\"') {
+				return error("Expected a string key");
+			}
+
+			entry key = { 0, 0, 0, kind::STRING, false };
+			if (!scan_string(key)) {
+				return error("Unterminated string, invalid escape sequence, control character or invalid UTF-8");
+			}
+			key.payload = HulaScript::Hash::strhash(key.flagged ? decode_string(key) : raw(key));
+			entries.push_back(key);
+
+			if (!skip_space()) {
+				return error("Expected each value to be on a single line");
+			}
+			if (p == end || *p != ':') {
+				return error("Expected ':' after key");
+			}
+			p++;
+			state = expect::VALUE;
+			break;
+		}
+		case expect::AFTER_VALUE: {
+			if (open.empty()) {
+				if (p == end) {
+					return std::nullopt;
+				}
+				else if (value_sequence) {
+					if (!newline) {
+						return error("Expected a newline between values");
+					}
+					state = expect::VALUE;
+					break;
+				}
+				return error("Unexpected trailing characters");
+			}
+
+			entry& container = entries[open.back()];
+			container.length++;
+
+			char closing = container.type == kind::OBJECT ? '}' : ']';
+			if (p < end && *p == ',') {
+				p++;
+				state = container.type == kind::OBJECT ? expect::KEY : expect::VALUE;
+			}
+			else if (p < end && *p == closing) {
+				p++;
+				container.payload = entries.size();
+				open.pop_back();
+			}
+			else {
+				return error(container.type == kind::OBJECT ? "Expected ',' or '}'" : "Expected ',' or ']'");
+			}
+			break;
+		}
+		}
+	}
+}
+
+std::string HulaUtils::json_tape::decode_string(const entry& current) const {
+	if (!current.flagged) {
+		return std::string(raw(current));
+	}
+
+	//escapes were validated by tokenize
+	std::string decoded;
+	decode_escapes(raw(current), decoded);
+	return decoded;
+}
+
+std::optional<uint32_t> HulaUtils::json_tape::find_field(uint32_t object_index, size_t key_hash) const noexcept {
+	uint32_t end = next(object_index);
+	for (uint32_t key = object_index + 1; key < end; key = next(key + 1)) {
+		if (entries[key].payload == key_hash) {
+			return key + 1;
+		}
+	}
+	return std::nullopt;
+}
+
+HulaScript::instance::value HulaUtils::json_tape::scalar_value(const entry& current, HulaScript::instance& instance) const {
+	switch (current.type)
+	{
+	case kind::STRING:
+		return instance.make_string(decode_string(current));
+	case kind::NUMBER:
+		return parse_number(raw(current), current.flagged, instance);
+	case kind::TRUE:
+		return HulaScript::instance::value(true);
+	case kind::FALSE:
+		return HulaScript::instance::value(false);
+	default:
+		return HulaScript::instance::value();
+	}
+}
+
+HulaScript::instance::value HulaUtils::json_tape::materialize(uint32_t index, HulaScript::instance& instance) const {
+	const entry& current = entries[index];
+	uint32_t end = next(index);
+
+	if (current.type == kind::ARRAY) {
+		std::vector<HulaScript::instance::value> elements;
+		elements.reserve(current.length);
+		for (uint32_t child = index + 1; child < end; child = next(child)) {
+			elements.push_back(materialize(child, instance));
+			instance.temp_gc_protect(elements.back());
+		}
+
+		auto array = instance.make_array(elements);
+		for (size_t i = 0; i < elements.size(); i++) {
+			instance.temp_gc_unprotect();
+		}
+		return array;
+	}
+	else if (current.type == kind::OBJECT) {
+		std::vector<std::pair<HulaScript::instance::value, HulaScript::instance::value>> fields;
+		fields.reserve(current.length);
+		for (uint32_t key = index + 1; key < end; key = next(key + 1)) {
+			auto key_value = scalar_value(entries[key], instance);
+			instance.temp_gc_protect(key_value);
+			auto value = materialize(key + 1, instance);
+			instance.temp_gc_protect(value);
+			fields.push_back(std::make_pair(key_value, value));
+		}
+
+		HulaScript::ffi_table_helper helper(fields.size(), instance);
+		for (auto& field : fields) {
+			helper.emplace(field.first, field.second);
+			instance.temp_gc_unprotect();
+			instance.temp_gc_unprotect();
+		}
+		return helper.get_table();
+	}
+	return scalar_value(current, instance);
+}
+
+HulaScript::instance::value HulaUtils::make_lazy_json(std::shared_ptr<const json_tape> tape, uint32_t index, HulaScript::instance& instance) {
+	const json_tape::entry& current = tape->entries[index];
+	if (current.type == json_tape::kind::OBJECT || current.type == json_tape::kind::ARRAY) {
+		return instance.add_foreign_object(std::make_unique<json_lazy_value>(tape, index));
+	}
+	return tape->scalar_value(current, instance);
+}
+
+const std::vector<uint32_t>& HulaUtils::json_lazy_value::children() {
+	const json_tape::entry& current = tape->entries[index];
+	if (child_indices.size() != current.length) {
+		child_indices.clear();
+		child_indices.reserve(current.length);
+
+		uint32_t end = tape->next(index);
+		for (uint32_t child = index + 1; child < end;) {
+			child_indices.push_back(child);
+			child = current.type == json_tape::kind::OBJECT ? tape->next(child + 1) : tape->next(child);
+		}
+	}
+	return child_indices;
+}
+
+std::optional<uint32_t> HulaUtils::json_lazy_value::field(size_t key_hash) {
+	const json_tape::entry& current = tape->entries[index];
+	if (current.type != json_tape::kind::OBJECT) {
+		return std::nullopt;
+	}
+	else if (current.length <= 16) {
+		return tape->find_field(index, key_hash);
+	}
+
+	if (field_lookup.empty()) {
+		field_lookup.reserve(current.length);
+		for (uint32_t key : children()) {
+			//first occurrence wins, matching find_field
+			field_lookup.insert({ static_cast<size_t>(tape->entries[key].payload), key + 1 });
+		}
+	}
+
+	auto it = field_lookup.find(key_hash);
+	if (it == field_lookup.end()) {
+		return std::nullopt;
+	}
+	return it->second;
+}
+
+HulaScript::instance::value HulaUtils::json_lazy_value::child_value(uint32_t child_index, HulaScript::instance& instance) {
+	auto it = cache.find(child_index);
+	if (it != cache.end()) {
+		return it->second;
+	}
+
+	auto value = make_lazy_json(tape, child_index, instance);
+	cache.insert({ child_index, value });
+	return value;
+}
+
+HulaScript::instance::value HulaUtils::json_lazy_value::load_property(size_t name_hash, HulaScript::instance& instance) {
+	auto member = foreign_getter_object::load_property(name_hash, instance);
+	if (!member.check_type(HulaScript::instance::value::vtype::NIL)) {
+		return member;
+	}
+
+	auto field_index = field(name_hash);
+	if (!field_index.has_value()) {
+		return HulaScript::instance::value();
+	}
+	return child_value(field_index.value(), instance);
+}
+
+HulaScript::instance::value HulaUtils::json_lazy_value::get(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(1);
+
+	if (tape->entries[index].type == json_tape::kind::ARRAY) {
+		const auto& elements = children();
+		size_t element = args[0].index(0, elements.size(), instance);
+		return child_value(elements[element], instance);
+	}
+
+	auto field_index = field(HulaScript::Hash::strhash(args[0].str(instance)));
+	if (!field_index.has_value()) {
+		return HulaScript::instance::value();
+	}
+	return child_value(field_index.value(), instance);
+}
+
+HulaScript::instance::value HulaUtils::json_lazy_value::has(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(1);
+
+	if (tape->entries[index].type == json_tape::kind::ARRAY) {
+		double element = args[0].number(instance);
+		return HulaScript::instance::value(element >= 0 && element < tape->entries[index].length && element == static_cast<size_t>(element));
+	}
+	return HulaScript::instance::value(field(HulaScript::Hash::strhash(args[0].str(instance))).has_value());
+}
+
+HulaScript::instance::value HulaUtils::json_lazy_value::keys(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(0);
+	if (tape->entries[index].type != json_tape::kind::OBJECT) {
+		instance.panic("JSON Error: keys() expects a JSON object, not an array.");
+	}
+
+	std::vector<HulaScript::instance::value> key_strs;
+	key_strs.reserve(tape->entries[index].length);
+	for (uint32_t key : children()) {
+		key_strs.push_back(instance.make_string(tape->decode_string(tape->entries[key])));
+		instance.temp_gc_protect(key_strs.back());
+	}
+
+	auto array = instance.make_array(key_strs);
+	for (size_t i = 0; i < key_strs.size(); i++) {
+		instance.temp_gc_unprotect();
+	}
+	return array;
+}
+
+HulaScript::instance::value HulaUtils::json_lazy_value::to_value(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(0);
+	return tape->materialize(index, instance);
+}
+
+HulaScript::instance::value HulaUtils::json_lazy_value::get_length(HulaScript::instance& instance)
+{
+	return instance.rational_integer(tape->entries[index].length);
+}
+
+std::string HulaUtils::json_lazy_value::to_string()
+{
+	return tape->entries[index].type == json_tape::kind::OBJECT ? "JSONObject" : "JSONArray";
+}
+
+HulaScript::instance::value HulaUtils::json_parser::parse_lazy(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(1);
+
+	auto tape = std::make_shared<json_tape>(args[0].str(instance));
+	auto error = tape->tokenize();
+	if (error.has_value()) {
+		instance.panic(error.value());
+	}
+	return make_lazy_json(tape, 0, instance);
+}
+
+//If input is a single top-level array, returns the offsets of the first commas between its elements at or after each of chunk_count - 1 evenly spaced targets.
+//This is only a structural scan (brackets, strings and escapes); each slice is still fully validated when it is tokenized.
+static std::optional<std::vector<size_t>> split_top_level_array(std::string_view input, size_t chunk_count) {
+	const char* begin = input.data();
+	const char* end = begin + input.size();
+	const char* p = begin;
+	while (p < end && is_json_space(*p)) {
+		p++;
+	}
+	if (p == end || *p != '[') {
+		return std::nullopt;
+	}
+
+	std::vector<size_t> commas;
+	size_t depth = 0;
+	for (; p < end; p++) {
+		switch (*p)
+		{
+		case '"':
+			p = HulaUtils::json_tape::find_quote_or_backslash(p + 1, end);
+			while (p < end && *p == '\\') {
+				p = HulaUtils::json_tape::find_quote_or_backslash(std::min(p + 2, end), end);
+			}
+			if (p == end) {
+				return std::nullopt;
+			}
+			break;
+		case '[':
+		case '{':
+			depth++;
+			break;
+		case ']':
+		case '}':
+			depth--;
+			break;
+		case ',': {
+			size_t offset = p - begin;
+			if (depth == 1 && commas.size() + 1 < chunk_count && offset >= input.size() * (commas.size() + 1) / chunk_count) {
+				commas.push_back(offset);
+			}
+			break;
+		}
+		}
+		if (depth == 0) {
+			break;
+		}
+	}
+	if (p == end) {
+		return std::nullopt;
+	}
+
+	//anything after the closing bracket means this is JSON Lines whose first record happens to be an array
+	for (p++; p < end && is_json_space(*p); p++) { }
+	if (p != end) {
+		return std::nullopt;
+	}
+	return commas;
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::parseJSONLines(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	//parallel_for also runs jobs on the calling thread
+	size_t chunk_count = worker_pool().size() + 1;
+	if (args.size() == 2) {
+		chunk_count = std::max<size_t>(1, args[1].size(instance));
+	}
+	else {
+		HULASCRIPT_EXPECT_ARGS(1);
+	}
+
+	//an existing file's path reads the file; anything else is the text itself
+	std::string argument = args[0].str(instance);
+	std::error_code error;
+	bool is_file = argument.find('\n') == std::string::npos && std::filesystem::is_regular_file(argument, error);
+	std::optional<file_contents> contents = is_file ? file_contents::load(argument) : std::nullopt;
+	if (is_file && !contents.has_value()) {
+		return HulaScript::instance::value();
+	}
+	std::string_view input = contents.has_value() ? contents->view() : std::string_view(argument);
+
+	//small inputs aren't worth the hand-off
+	static constexpr size_t min_chunk_size = 64 * 1024;
+	chunk_count = std::min(chunk_count, input.size() / min_chunk_size + 1);
+
+	//a single top-level array is split at commas between its elements; each slice is re-bracketed and tokenized as an array of its own
+	auto commas = split_top_level_array(input, chunk_count);
+	if (commas.has_value()) {
+		std::vector<std::unique_ptr<json_tape>> tapes(commas->size() + 1);
+		std::vector<std::optional<std::string>> errors(tapes.size());
+		worker_pool().parallel_for(tapes.size(), [&](size_t i) {
+			size_t start = i == 0 ? 0 : commas->at(i - 1);
+			size_t stop = i == commas->size() ? input.size() : commas->at(i);
+
+			std::string slice;
+			slice.reserve(stop - start + 1);
+			if (i > 0) {
+				//the comma's position stands in for the added bracket, so error offsets still refer to the whole input
+				slice.push_back('[');
+				start++;
+			}
+			slice.append(input.substr(start, stop - start));
+			if (i < commas->size()) {
+				slice.push_back(']');
+			}
+
+			tapes[i] = std::make_unique<json_tape>(std::move(slice));
+			tapes[i]->source_offset = i == 0 ? 0 : commas->at(i - 1);
+			errors[i] = tapes[i]->tokenize();
+		});
+
+		for (auto& chunk_error : errors) {
+			if (chunk_error.has_value()) {
+				instance.panic(chunk_error.value());
+			}
+		}
+
+		std::vector<HulaScript::instance::value> elements;
+		for (auto& tape : tapes) {
+			for (uint32_t child = 1; child < tape->entries[0].payload; child = tape->next(child)) {
+				elements.push_back(tape->materialize(child, instance));
+				instance.temp_gc_protect(elements.back());
+			}
+			tape.reset();
+		}
+
+		auto result = instance.make_array(elements);
+		for (size_t i = 0; i < elements.size(); i++) {
+			instance.temp_gc_unprotect();
+		}
+		return result;
+	}
+
+	//chunks end just after a newline, so every record lies within one chunk
+	std::vector<size_t> boundaries;
+	boundaries.push_back(0);
+	for (size_t i = 1; i < chunk_count; i++) {
+		size_t target = std::max(boundaries.back(), input.size() * i / chunk_count);
+		size_t newline = input.find('\n', target);
+		if (newline == std::string_view::npos) {
+			break;
+		}
+		if (newline + 1 > boundaries.back()) {
+			boundaries.push_back(newline + 1);
+		}
+	}
+	boundaries.push_back(input.size());
+
+	std::vector<std::unique_ptr<json_tape>> tapes(boundaries.size() - 1);
+	std::vector<std::optional<std::string>> errors(tapes.size());
+	worker_pool().parallel_for(tapes.size(), [&](size_t i) {
+		tapes[i] = std::make_unique<json_tape>(std::string(input.substr(boundaries[i], boundaries[i + 1] - boundaries[i])));
+		tapes[i]->source_offset = boundaries[i];
+		errors[i] = tapes[i]->tokenize(true);
+	});
+
+	for (auto& chunk_error : errors) {
+		if (chunk_error.has_value()) {
+			instance.panic(chunk_error.value());
+		}
+	}
+
+	//only the interpreter thread creates script values, in input order
+	std::vector<HulaScript::instance::value> records;
+	for (auto& tape : tapes) {
+		for (uint32_t root = 0; root < tape->entries.size(); root = tape->next(root)) {
+			records.push_back(tape->materialize(root, instance));
+			instance.temp_gc_protect(records.back());
+		}
+		tape.reset();
+	}
+
+	auto result = instance.make_array(records);
+	for (size_t i = 0; i < records.size(); i++) {
+		instance.temp_gc_unprotect();
+	}
+	return result;
+}
@@ -0,0 +1,603 @@
+#include "HulaUtils.hpp"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <sstream>
+
+using namespace HulaUtils;
+
+static constexpr HulaScript::interned_key json_keys_key("@json_keys");
+static constexpr HulaScript::interned_key json_constructor_key("@json_constructor");
+
+//MessagePack extension types for values that have no native MessagePack form
+enum binary_ext_type : int8_t {
+	RATIONAL_EXT = 1, //"numerator/denominator" text, exactly as parse_rational reads it
+	FLOAT64_ARRAY_EXT = 2, //raw little-endian elements
+	INT64_ARRAY_EXT = 3,
+	JSON_TEXT_EXT = 4 //whatever an object's toJSON method returned
+};
+
+//array payloads are little-endian on the wire; big-endian hosts swap each 8 byte element in place
+static void swap_little_endian_elements(uint8_t* bytes, size_t size) {
+	if constexpr (std::endian::native == std::endian::big) {
+		for (size_t i = 0; i + 8 <= size; i += 8) {
+			std::reverse(bytes + i, bytes + i + 8);
+		}
+	}
+}
+
+class msgpack_writer {
+private:
+	std::vector<uint8_t>& out;
+	HulaScript::instance& instance;
+
+	void put_byte(uint8_t byte) {
+		out.push_back(byte);
+	}
+
+	void put_big_endian(uint64_t value, int bytes) {
+		for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+			out.push_back(static_cast<uint8_t>(value >> shift));
+		}
+	}
+
+	void put_bytes(const void* data, size_t size) {
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		out.insert(out.end(), bytes, bytes + size);
+	}
+
+	//picks the smallest sized header; tag8 is 0 for formats without an 8-bit length
+	void put_length(size_t length, uint8_t tag8, uint8_t tag16, uint8_t tag32) {
+		if (length <= UINT8_MAX && tag8 != 0) {
+			put_byte(tag8);
+			put_big_endian(length, 1);
+		}
+		else if (length <= UINT16_MAX) {
+			put_byte(tag16);
+			put_big_endian(length, 2);
+		}
+		else if (length <= UINT32_MAX) {
+			put_byte(tag32);
+			put_big_endian(length, 4);
+		}
+		else {
+			instance.panic("Binary Error: Values of 4 GiB or more can't be serialized.");
+		}
+	}
+
+	void put_unsigned(uint64_t value) {
+		if (value < 0x80) {
+			put_byte(static_cast<uint8_t>(value));
+		}
+		else if (value <= UINT8_MAX) {
+			put_byte(0xcc);
+			put_big_endian(value, 1);
+		}
+		else if (value <= UINT16_MAX) {
+			put_byte(0xcd);
+			put_big_endian(value, 2);
+		}
+		else if (value <= UINT32_MAX) {
+			put_byte(0xce);
+			put_big_endian(value, 4);
+		}
+		else {
+			put_byte(0xcf);
+			put_big_endian(value, 8);
+		}
+	}
+
+	void put_signed(int64_t value) {
+		if (value >= 0) {
+			put_unsigned(static_cast<uint64_t>(value));
+		}
+		else if (value >= -32) {
+			put_byte(static_cast<uint8_t>(value));
+		}
+		else if (value >= INT8_MIN) {
+			put_byte(0xd0);
+			put_big_endian(static_cast<uint64_t>(value), 1);
+		}
+		else if (value >= INT16_MIN) {
+			put_byte(0xd1);
+			put_big_endian(static_cast<uint64_t>(value), 2);
+		}
+		else if (value >= INT32_MIN) {
+			put_byte(0xd2);
+			put_big_endian(static_cast<uint64_t>(value), 4);
+		}
+		else {
+			put_byte(0xd3);
+			put_big_endian(static_cast<uint64_t>(value), 8);
+		}
+	}
+
+	void put_string(const char* data, size_t size) {
+		if (size < 32) {
+			put_byte(static_cast<uint8_t>(0xa0 | size));
+		}
+		else {
+			put_length(size, 0xd9, 0xda, 0xdb);
+		}
+		put_bytes(data, size);
+	}
+
+	void put_ext(binary_ext_type type, const void* data, size_t size) {
+		put_length(size, 0xc7, 0xc8, 0xc9);
+		put_byte(static_cast<uint8_t>(type));
+		put_bytes(data, size);
+	}
+
+	void put_rational(HulaScript::instance::value& rational) {
+		std::string text = instance.rational_to_string(rational, true);
+		const char* first = text.data();
+		const char* last = text.data() + text.size();
+
+		//whole numbers become plain MessagePack integers, so other readers see them as such
+		if (text.find('/') == std::string::npos) {
+			if (text[0] == '-') {
+				int64_t integer;
+				auto result = std::from_chars(first, last, integer);
+				if (result.ec == std::errc() && result.ptr == last) {
+					put_signed(integer);
+					return;
+				}
+			}
+			else {
+				uint64_t integer;
+				auto result = std::from_chars(first, last, integer);
+				if (result.ec == std::errc() && result.ptr == last) {
+					put_unsigned(integer);
+					return;
+				}
+			}
+		}
+		put_ext(RATIONAL_EXT, text.data(), text.size());
+	}
+
+	void put_table(HulaScript::instance::value& current) {
+		HulaScript::ffi_table_helper helper(current, instance);
+
+		if (helper.is_array()) {
+			size_t size = helper.get_size();
+			if (size < 16) {
+				put_byte(static_cast<uint8_t>(0x90 | size));
+			}
+			else {
+				put_length(size, 0, 0xdc, 0xdd);
+			}
+			for (size_t i = 0; i < size; i++) {
+				auto elem = helper.get(instance.rational_integer(i));
+				write(elem);
+			}
+			return;
+		}
+
+		auto key_value = helper.get(json_keys_key);
+		if (key_value.check_type(HulaScript::instance::value::vtype::NIL)) {
+			put_json_text(current);
+			return;
+		}
+
+		//same layout as toJSON: the listed fields, then @json_constructor, then @json_keys itself
+		HulaScript::ffi_table_helper key_table_helper(key_value, instance);
+		if (!key_table_helper.is_array()) {
+			instance.panic("@json_keys property must be an array.");
+		}
+
+		size_t key_count = key_table_helper.get_size();
+		auto constructor_value = helper.get(json_constructor_key);
+		bool has_constructor = !constructor_value.check_type(HulaScript::instance::value::vtype::NIL);
+
+		size_t entry_count = key_count + (has_constructor ? 2 : 1);
+		if (entry_count < 16) {
+			put_byte(static_cast<uint8_t>(0x80 | entry_count));
+		}
+		else {
+			put_length(entry_count, 0, 0xde, 0xdf);
+		}
+
+		for (size_t i = 0; i < key_count; i++) {
+			std::string key = key_table_helper.get(instance.rational_integer(i)).str(instance);
+			put_string(key.data(), key.size());
+			auto elem = helper.get(HulaScript::interned_key(key));
+			write(elem);
+		}
+		if (has_constructor) {
+			put_string("@json_constructor", 17);
+			write(constructor_value);
+		}
+		put_string("@json_keys", 10);
+		write(key_value);
+	}
+
+	//anything else goes through its toJSON method, as toJSON itself would do
+	void put_json_text(HulaScript::instance::value& current) {
+		std::string json_source = instance.invoke_method(current, "toJSON", {}).str(instance);
+		put_ext(JSON_TEXT_EXT, json_source.data(), json_source.size());
+	}
+
+public:
+	msgpack_writer(std::vector<uint8_t>& out, HulaScript::instance& instance) : out(out), instance(instance) { }
+
+	void write(HulaScript::instance::value& current) {
+		if (current.check_type(HulaScript::instance::value::vtype::NIL)) {
+			put_byte(0xc0);
+		}
+		else if (current.check_type(HulaScript::instance::value::vtype::BOOLEAN)) {
+			put_byte(current.boolean(instance) ? 0xc3 : 0xc2);
+		}
+		else if (current.check_type(HulaScript::instance::value::vtype::DOUBLE)) {
+			double number = current.number(instance);
+			uint64_t bits;
+			std::memcpy(&bits, &number, sizeof(bits));
+			put_byte(0xcb);
+			put_big_endian(bits, 8);
+		}
+		else if (current.check_type(HulaScript::instance::value::vtype::RATIONAL)) {
+			put_rational(current);
+		}
+		else if (current.check_type(HulaScript::instance::value::vtype::STRING)) {
+			std::string str = current.str(instance);
+			put_string(str.data(), str.size());
+		}
+		else if (current.check_type(HulaScript::instance::value::vtype::TABLE)) {
+			put_table(current);
+		}
+		else if (current.check_type(HulaScript::instance::value::vtype::FOREIGN_OBJECT)) {
+			HulaScript::instance::foreign_object* object = current.foreign_obj(instance);
+			if (auto buffer = dynamic_cast<buffer_object*>(object)) {
+				put_length(buffer->length(), 0xc4, 0xc5, 0xc6);
+				put_bytes(buffer->data_bytes(), buffer->length());
+			}
+			else if (auto doubles = dynamic_cast<float64_array*>(object)) {
+				put_ext(FLOAT64_ARRAY_EXT, doubles->data_bytes(), doubles->length() * sizeof(double));
+				swap_little_endian_elements(out.data() + out.size() - doubles->length() * sizeof(double), doubles->length() * sizeof(double));
+			}
+			else if (auto integers = dynamic_cast<int64_array*>(object)) {
+				put_ext(INT64_ARRAY_EXT, integers->data_bytes(), integers->length() * sizeof(int64_t));
+				swap_little_endian_elements(out.data() + out.size() - integers->length() * sizeof(int64_t), integers->length() * sizeof(int64_t));
+			}
+			else {
+				put_json_text(current);
+			}
+		}
+		else {
+			put_json_text(current);
+		}
+	}
+};
+
+class msgpack_reader {
+private:
+	const uint8_t* begin;
+	const uint8_t* p;
+	const uint8_t* end;
+
+	HulaScript::instance& instance;
+	const json_constructor_plans& object_parsers;
+	std::function<HulaScript::instance::value(std::string)> parse_json_text;
+
+	void fail(const char* message) {
+		std::stringstream ss;
+		ss << "Binary Parse Error: " << message << " at offset " << (p - begin) << ".";
+		instance.panic(ss.str());
+	}
+
+	const uint8_t* take(size_t count) {
+		if (static_cast<size_t>(end - p) < count) {
+			fail("Unexpected end of input");
+		}
+		const uint8_t* start = p;
+		p += count;
+		return start;
+	}
+
+	uint64_t take_big_endian(int bytes) {
+		const uint8_t* start = take(bytes);
+		uint64_t value = 0;
+		for (int i = 0; i < bytes; i++) {
+			value = (value << 8) | start[i];
+		}
+		return value;
+	}
+
+	int64_t take_signed(int bytes) {
+		uint64_t value = take_big_endian(bytes);
+		int shift = 64 - bytes * 8;
+		return static_cast<int64_t>(value << shift) >> shift;
+	}
+
+	HulaScript::instance::value make_unsigned(uint64_t value) {
+		if (value > INT64_MAX) {
+			return instance.parse_rational(std::to_string(value));
+		}
+		return instance.rational_integer(static_cast<int64_t>(value));
+	}
+
+	HulaScript::instance::value read_array(size_t count) {
+		std::vector<HulaScript::instance::value> elements;
+		elements.reserve(std::min<size_t>(count, end - p));
+		for (size_t i = 0; i < count; i++) {
+			elements.push_back(read());
+			instance.temp_gc_protect(elements.back());
+		}
+
+		auto result = instance.make_array(elements);
+		for (size_t i = 0; i < count; i++) {
+			instance.temp_gc_unprotect();
+		}
+		return result;
+	}
+
+	HulaScript::instance::value read_map(size_t count) {
+		std::vector<json_field> fields;
+		fields.reserve(std::min<size_t>(count, (end - p) / 2));
+		size_t protected_count = 0;
+		for (size_t i = 0; i < count; i++) {
+			json_field field;
+			auto key = take_string();
+			if (key.has_value()) {
+				field.string_key = true;
+				field.key = std::string(key.value());
+				field.key_hash = HulaScript::Hash::strhash(field.key);
+			}
+			else {
+				field.string_key = false;
+				field.key_hash = 0;
+				field.key_value = read();
+				instance.temp_gc_protect(field.key_value);
+				protected_count++;
+			}
+			field.value = read();
+			instance.temp_gc_protect(field.value);
+			protected_count++;
+			fields.push_back(std::move(field));
+		}
+
+		auto result = build_json_object(fields, object_parsers, instance);
+		for (size_t i = 0; i < protected_count; i++) {
+			instance.temp_gc_unprotect();
+		}
+		return result;
+	}
+
+	//consumes a string header and body if one is next, without making a script string
+	std::optional<std::string_view> take_string() {
+		if (p == end) {
+			fail("Unexpected end of input");
+		}
+
+		uint8_t tag = *p;
+		size_t size;
+		if ((tag & 0xe0) == 0xa0) {
+			p++;
+			size = tag & 0x1f;
+		}
+		else if (tag >= 0xd9 && tag <= 0xdb) {
+			p++;
+			size = take_big_endian(1 << (tag - 0xd9));
+		}
+		else {
+			return std::nullopt;
+		}
+		const uint8_t* start = take(size);
+		return std::string_view(reinterpret_cast<const char*>(start), size);
+	}
+
+	HulaScript::instance::value read_ext(size_t size) {
+		int8_t type = static_cast<int8_t>(*take(1));
+		const uint8_t* payload = take(size);
+
+		switch (type)
+		{
+		case RATIONAL_EXT:
+			return instance.parse_rational(std::string(reinterpret_cast<const char*>(payload), size));
+		case FLOAT64_ARRAY_EXT: {
+			if (size % sizeof(double) != 0) {
+				fail("Malformed Float64Array");
+			}
+			std::vector<double> elements(size / sizeof(double));
+			std::memcpy(elements.data(), payload, size);
+			swap_little_endian_elements(reinterpret_cast<uint8_t*>(elements.data()), size);
+			return instance.add_foreign_object(std::make_unique<float64_array>(std::move(elements)));
+		}
+		case INT64_ARRAY_EXT: {
+			if (size % sizeof(int64_t) != 0) {
+				fail("Malformed Int64Array");
+			}
+			std::vector<int64_t> elements(size / sizeof(int64_t));
+			std::memcpy(elements.data(), payload, size);
+			swap_little_endian_elements(reinterpret_cast<uint8_t*>(elements.data()), size);
+			return instance.add_foreign_object(std::make_unique<int64_array>(std::move(elements)));
+		}
+		case JSON_TEXT_EXT:
+			return parse_json_text(std::string(reinterpret_cast<const char*>(payload), size));
+		default:
+			fail("Unknown extension type");
+			return HulaScript::instance::value(); //unreachable
+		}
+	}
+
+	HulaScript::instance::value read_string(size_t size) {
+		const uint8_t* start = take(size);
+		return instance.make_string(std::string(reinterpret_cast<const char*>(start), size));
+	}
+
+	HulaScript::instance::value read_bytes(size_t size) {
+		const uint8_t* start = take(size);
+		return instance.add_foreign_object(std::make_unique<buffer_object>(std::vector<uint8_t>(start, start + size)));
+	}
+
+public:
+	msgpack_reader(std::string_view source, const json_constructor_plans& object_parsers, std::function<HulaScript::instance::value(std::string)> parse_json_text, HulaScript::instance& instance)
+		: begin(reinterpret_cast<const uint8_t*>(source.data())), p(begin), end(begin + source.size()), instance(instance), object_parsers(object_parsers), parse_json_text(parse_json_text) { }
+
+	HulaScript::instance::value read() {
+		uint8_t tag = *take(1);
+
+		if (tag < 0x80) {
+			return instance.rational_integer(tag);
+		}
+		else if (tag >= 0xe0) {
+			return instance.rational_integer(static_cast<int8_t>(tag));
+		}
+		else if ((tag & 0xf0) == 0x80) {
+			return read_map(tag & 0x0f);
+		}
+		else if ((tag & 0xf0) == 0x90) {
+			return read_array(tag & 0x0f);
+		}
+		else if ((tag & 0xe0) == 0xa0) {
+			return read_string(tag & 0x1f);
+		}
+
+		switch (tag)
+		{
+		case 0xc0:
+			return HulaScript::instance::value();
+		case 0xc2:
+			return HulaScript::instance::value(false);
+		case 0xc3:
+			return HulaScript::instance::value(true);
+		case 0xc4:
+			return read_bytes(take_big_endian(1));
+		case 0xc5:
+			return read_bytes(take_big_endian(2));
+		case 0xc6:
+			return read_bytes(take_big_endian(4));
+		case 0xc7:
+			return read_ext(take_big_endian(1));
+		case 0xc8:
+			return read_ext(take_big_endian(2));
+		case 0xc9:
+			return read_ext(take_big_endian(4));
+		case 0xca: {
+			uint32_t bits = static_cast<uint32_t>(take_big_endian(4));
+			float number;
+			std::memcpy(&number, &bits, sizeof(number));
+			return HulaScript::instance::value(static_cast<double>(number));
+		}
+		case 0xcb: {
+			uint64_t bits = take_big_endian(8);
+			double number;
+			std::memcpy(&number, &bits, sizeof(number));
+			return HulaScript::instance::value(number);
+		}
+		case 0xcc:
+			return make_unsigned(take_big_endian(1));
+		case 0xcd:
+			return make_unsigned(take_big_endian(2));
+		case 0xce:
+			return make_unsigned(take_big_endian(4));
+		case 0xcf:
+			return make_unsigned(take_big_endian(8));
+		case 0xd0:
+			return instance.rational_integer(take_signed(1));
+		case 0xd1:
+			return instance.rational_integer(take_signed(2));
+		case 0xd2:
+			return instance.rational_integer(take_signed(4));
+		case 0xd3:
+			return instance.rational_integer(take_signed(8));
+		case 0xd4:
+			return read_ext(1);
+		case 0xd5:
+			return read_ext(2);
+		case 0xd6:
+			return read_ext(4);
+		case 0xd7:
+			return read_ext(8);
+		case 0xd8:
+			return read_ext(16);
+		case 0xd9:
+			return read_string(take_big_endian(1));
+		case 0xda:
+			return read_string(take_big_endian(2));
+		case 0xdb:
+			return read_string(take_big_endian(4));
+		case 0xdc:
+			return read_array(take_big_endian(2));
+		case 0xdd:
+			return read_array(take_big_endian(4));
+		case 0xde:
+			return read_map(take_big_endian(2));
+		case 0xdf:
+			return read_map(take_big_endian(4));
+		default:
+			fail("Invalid type byte");
+			return HulaScript::instance::value(); //unreachable
+		}
+	}
+
+	void finish() {
+		if (p != end) {
+			fail("Unexpected trailing bytes");
+		}
+	}
+};
+
+static std::vector<uint8_t> serialize_binary(HulaScript::instance::value& value, HulaScript::instance& instance) {
+	std::vector<uint8_t> out;
+	msgpack_writer writer(out, instance);
+	writer.write(value);
+	return out;
+}
+
+HulaScript::instance::value HulaUtils::json_parser::parse_binary(std::string_view source, HulaScript::instance& instance)
+{
+	msgpack_reader reader(source, object_parsers, [this, &instance](std::string json_source) {
+		HulaScript::instance::value argument = instance.make_string(json_source);
+		return parse_json(std::span<HulaScript::instance::value>(&argument, 1), instance);
+	}, instance);
+
+	auto result = reader.read();
+	reader.finish();
+	return result;
+}
+
+HulaScript::instance::value HulaUtils::json_parser::from_binary(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(1);
+
+	if (args[0].check_type(HulaScript::instance::value::vtype::STRING)) {
+		std::string source = args[0].str(instance);
+		return parse_binary(source, instance);
+	}
+
+	native_array& array = expect_native_array(args[0], instance);
+	return parse_binary(std::string_view(array.data_bytes(), array.length() * array.element_size()), instance);
+}
+
+HulaScript::instance::value HulaUtils::json_parser::from_binary_file(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(1);
+
+	auto contents = file_contents::load(args[0].str(instance));
+	if (!contents.has_value()) {
+		return HulaScript::instance::value();
+	}
+	return parse_binary(contents->view(), instance);
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::toBinary(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(1);
+
+	return instance.add_foreign_object(std::make_unique<buffer_object>(serialize_binary(args[0], instance)));
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::toBinaryFile(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	bool atomic = false;
+	if (args.size() == 3) {
+		atomic = args[2].boolean(instance);
+	}
+	else {
+		HULASCRIPT_EXPECT_ARGS(2);
+	}
+
+	std::vector<uint8_t> out = serialize_binary(args[1], instance);
+	return HulaScript::instance::value(write_whole_file(args[0].str(instance), reinterpret_cast<const char*>(out.data()), out.size(), atomic));
+}
@@ -0,0 +1,294 @@
+#include "HulaUtils.hpp"
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+static constexpr uint32_t watch_mask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+#endif
+
+using namespace HulaUtils;
+
+HulaUtils::watch_object::~watch_object() {
+#ifdef __linux__
+	if (fd >= 0) {
+		::close(fd);
+	}
+#endif
+}
+
+bool HulaUtils::watch_object::add_watch(const std::string& path) {
+#ifdef __linux__
+	int wd = inotify_add_watch(fd, path.c_str(), watch_mask);
+	if (wd < 0) {
+		return false;
+	}
+	watched_paths[wd] = path;
+	return true;
+#else
+	return false;
+#endif
+}
+
+void HulaUtils::watch_object::add_root(const std::string& path, HulaScript::instance& instance) {
+	if (!add_watch(path)) {
+		std::stringstream ss;
+		ss << "Unable to watch \"" << path << "\": " << std::strerror(errno);
+		instance.panic(ss.str());
+	}
+
+	std::error_code error;
+	if (!recursive || !std::filesystem::is_directory(path, error)) {
+		return;
+	}
+
+	//subdirectories that vanish or can't be read while we walk are skipped, not fatal
+	for (auto it = std::filesystem::recursive_directory_iterator(path, std::filesystem::directory_options::skip_permission_denied, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+		if (it->is_directory(error)) {
+			add_watch(it->path().string());
+		}
+	}
+}
+
+//merges a raw change into the pending batch, so a burst of writes to one path reports once
+void HulaUtils::watch_object::record(const std::string& path, int change) {
+	auto it = pending_index.find(path);
+	if (it == pending_index.end()) {
+		pending_index.insert({ path, pending.size() });
+		pending.push_back({ path, change });
+		return;
+	}
+
+	int& current = pending[it->second].second;
+	switch (change)
+	{
+	case CREATED:
+		//deleted then recreated within one batch reads as a modification
+		current = (current & DELETED) ? MODIFIED : CREATED;
+		break;
+	case DELETED:
+		if (current & CREATED) {
+			//created and removed within one batch; nothing observable changed
+			current = 0;
+			pending_index.erase(it);
+		}
+		else {
+			current = DELETED;
+		}
+		break;
+	case MODIFIED:
+		if (!(current & (CREATED | DELETED))) {
+			current |= MODIFIED;
+		}
+		break;
+	default:
+		current |= change;
+		break;
+	}
+}
+
+bool HulaUtils::watch_object::drain_events(int timeout_ms) {
+#ifdef __linux__
+	struct pollfd request = { fd, POLLIN, 0 };
+	if (::poll(&request, 1, timeout_ms) <= 0) {
+		return false;
+	}
+
+	alignas(struct inotify_event) char buffer[64 * 1024];
+	for (;;) {
+		ssize_t length = read(fd, buffer, sizeof(buffer));
+		if (length < 0 && errno == EINTR) {
+			continue;
+		}
+		else if (length <= 0) {
+			break;
+		}
+
+		for (char* cursor = buffer; cursor < buffer + length;) {
+			const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(cursor);
+			cursor += sizeof(struct inotify_event) + event->len;
+
+			if (event->mask & IN_Q_OVERFLOW) {
+				record("", OVERFLOWED);
+				continue;
+			}
+
+			auto it = watched_paths.find(event->wd);
+			if (it == watched_paths.end()) {
+				continue;
+			}
+			if (event->mask & IN_IGNORED) {
+				watched_paths.erase(it);
+				continue;
+			}
+
+			std::string path = event->len > 0 ? (std::filesystem::path(it->second) / event->name).string() : it->second;
+			if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+				record(path, CREATED);
+
+				if (recursive && (event->mask & IN_ISDIR) && add_watch(path)) {
+					//anything created before the new watch was in place would otherwise go unreported
+					std::error_code error;
+					for (auto entry = std::filesystem::recursive_directory_iterator(path, std::filesystem::directory_options::skip_permission_denied, error); !error && entry != std::filesystem::recursive_directory_iterator(); entry.increment(error)) {
+						if (entry->is_directory(error)) {
+							add_watch(entry->path().string());
+						}
+						record(entry->path().string(), CREATED);
+					}
+				}
+			}
+			else if (event->mask & (IN_DELETE | IN_MOVED_FROM | IN_DELETE_SELF | IN_MOVE_SELF)) {
+				record(path, DELETED);
+			}
+			else {
+				record(path, MODIFIED);
+			}
+		}
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+HulaScript::instance::value HulaUtils::watch_object::take_batch(HulaScript::instance& instance) {
+	std::vector<HulaScript::instance::value> events;
+	events.reserve(pending.size());
+	for (auto& change : pending) {
+		const char* kind;
+		if (change.second & OVERFLOWED) {
+			kind = "overflow";
+		}
+		else if (change.second & DELETED) {
+			kind = "deleted";
+		}
+		else if (change.second & CREATED) {
+			kind = "created";
+		}
+		else if (change.second & MODIFIED) {
+			kind = "modified";
+		}
+		else {
+			continue;
+		}
+
+		auto path = instance.make_string(change.first);
+		instance.temp_gc_protect(path);
+		auto event = instance.make_string(kind);
+		instance.temp_gc_protect(event);
+		auto entry = instance.make_table_obj({
+			std::make_pair("path", path),
+			std::make_pair("event", event)
+		});
+		instance.temp_gc_unprotect();
+		instance.temp_gc_unprotect();
+
+		events.push_back(entry);
+		instance.temp_gc_protect(entry);
+	}
+
+	pending.clear();
+	pending_index.clear();
+
+	auto result = instance.make_array(events);
+	for (size_t i = 0; i < events.size(); i++) {
+		instance.temp_gc_unprotect();
+	}
+	return result;
+}
+
+HulaScript::instance::value HulaUtils::watch_object::poll(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(0);
+	if (fd < 0) {
+		instance.panic("Watcher object is closed.");
+	}
+
+	drain_events(0);
+	return take_batch(instance);
+}
+
+HulaScript::instance::value HulaUtils::watch_object::next(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	int timeout_ms = -1;
+	if (args.size() == 1) {
+		double timeout = args[0].number(instance);
+		timeout_ms = timeout < 0 ? -1 : static_cast<int>(std::min(timeout * 1000, static_cast<double>(INT32_MAX)));
+	}
+	else {
+		HULASCRIPT_EXPECT_ARGS(0);
+	}
+	if (fd < 0) {
+		instance.panic("Watcher object is closed.");
+	}
+
+	if (drain_events(timeout_ms)) {
+		//pick up the rest of the burst that arrived while we were reading
+		while (drain_events(0)) { }
+	}
+	return take_batch(instance);
+}
+
+HulaScript::instance::value HulaUtils::watch_object::close(std::span<HulaScript::instance::value> args, HulaScript::instance& instance)
+{
+	HULASCRIPT_EXPECT_ARGS(0);
+	if (fd < 0) {
+		instance.panic("Watcher object is closed.");
+	}
+
+#ifdef __linux__
+	::close(fd);
+#endif
+	fd = -1;
+	watched_paths.clear();
+	pending.clear();
+	pending_index.clear();
+
+	return HulaScript::instance::value();
+}
+
+DYNALO_EXPORT HulaScript::instance::value DYNALO_CALL HulaUtils::watch(std::vector<HulaScript::instance::value>& args, HulaScript::instance& instance)
+{
+	bool recursive = false;
+	if (args.size() == 2) {
+		recursive = args[1].boolean(instance);
+	}
+	else {
+		HULASCRIPT_EXPECT_ARGS(1);
+	}
+
+	std::vector<std::string> paths;
+	if (args[0].check_type(HulaScript::instance::value::vtype::TABLE)) {
+		HulaScript::ffi_table_helper helper(args[0], instance);
+		size_t count = helper.get_size();
+		for (size_t i = 0; i < count; i++) {
+			paths.push_back(helper.get(instance.rational_integer(i)).str(instance));
+		}
+	}
+	else {
+		paths.push_back(args[0].str(instance));
+	}
+
+#ifdef __linux__
+	int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd < 0) {
+		std::stringstream ss;
+		ss << "Unable to create watcher: " << std::strerror(errno);
+		instance.panic(ss.str());
+	}
+
+	auto watcher = std::make_unique<watch_object>(fd, recursive);
+	for (const std::string& path : paths) {
+		watcher->add_root(path, instance);
+	}
+	return instance.add_foreign_object(std::move(watcher));
+#else
+	instance.panic("watch is only supported on Linux (inotify).");
+	return HulaScript::instance::value(); //unreachable
+#endif
+}